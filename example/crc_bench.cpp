@@ -0,0 +1,127 @@
+/*
+ * 校验算法微基准：从数据库读出已存储的原始帧(frame BLOB，旧库为 frame_hex)，
+ * 分别用可移植实现和运行时选择的实现(aarch64 上为 PMULL / NEON)重新校验，比较耗时。
+ * 用法: crc_bench [lop1.db] [lop2.db] [重复次数]
+ */
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <sqlite3.h>
+
+#include "crc16.h"
+#include "checksum.h"
+
+using namespace std;
+
+typedef vector<vector<uint8_t>> FrameList;
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// 读出某张表的所有原始帧
+static void loadFrames(const string& dbPath, const string& table, FrameList& frames) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        cerr << "open " << dbPath << " failed" << endl;
+        sqlite3_close(db);
+        return;
+    }
+
+    string sql = "SELECT frame FROM " + table + ";";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const uint8_t* blob = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, 0));
+            int len = sqlite3_column_bytes(stmt, 0);
+            if (blob) frames.push_back(vector<uint8_t>(blob, blob + len));
+        }
+    } else if (sqlite3_prepare_v2(db, ("SELECT frame_hex FROM " + table + ";").c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* hex = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            int len = sqlite3_column_bytes(stmt, 0);
+            if (!hex || len % 2) continue;
+            vector<uint8_t> frame(len / 2);
+            for (int i = 0; i < len / 2; ++i) {
+                frame[i] = uint8_t(hexNibble(hex[2 * i]) << 4 | hexNibble(hex[2 * i + 1]));
+            }
+            frames.push_back(frame);
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+// 数据库中没有数据时，生成随机帧
+static void synthFrames(size_t frameLen, size_t count, FrameList& frames) {
+    for (size_t n = 0; n < count; ++n) {
+        vector<uint8_t> frame(frameLen);
+        for (size_t i = 0; i < frameLen; ++i) frame[i] = uint8_t(rand());
+        frames.push_back(frame);
+    }
+}
+
+template <typename Fn>
+static double timeIt(int rounds, Fn fn) {
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) fn();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration<double>(t1 - t0).count();
+}
+
+static void report(const char* name, size_t bytes, int rounds, double base, double fast) {
+    double mb = double(bytes) * rounds / (1024.0 * 1024.0);
+    cout << name << ": portable " << mb / base << " MB/s, dispatched "
+         << mb / fast << " MB/s, speedup x" << base / fast << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string lop1Path = argc > 1 ? argv[1] : "/userdata/sqlite/lop1.db";
+    string lop2Path = argc > 2 ? argv[2] : "/media/udisk0/test.db";
+    int rounds = argc > 3 ? atoi(argv[3]) : 200;
+
+    FrameList lop1Frames, lop2Frames;
+    loadFrames(lop1Path, "lop1_frame1", lop1Frames);
+    loadFrames(lop1Path, "lop1_frame2", lop1Frames);
+    loadFrames(lop2Path, "lop2_frame", lop2Frames);
+    if (lop1Frames.empty()) synthFrames(35, 100000, lop1Frames);
+    if (lop2Frames.empty()) synthFrames(65, 100000, lop2Frames);
+
+    cout << "crc16 impl: " << crc16_modbus_impl()
+         << ", sum8 impl: " << checksum_sum8_impl() << endl;
+    cout << "lop1 frames: " << lop1Frames.size() << ", lop2 frames: " << lop2Frames.size() << endl;
+
+    volatile uint32_t sink = 0;
+    size_t bytes = 0;
+
+    // 1) LOP1 累加和逐帧校验
+    for (const auto& f : lop1Frames) bytes += f.size();
+    double base = timeIt(rounds, [&] { for (const auto& f : lop1Frames) sink += checksum_sum8_portable(f.data(), f.size()); });
+    double fast = timeIt(rounds, [&] { for (const auto& f : lop1Frames) sink += checksum_sum8(f.data(), f.size()); });
+    report("lop1 sum8 per-frame", bytes, rounds, base, fast);
+
+    // 2) LOP2 CRC16 逐帧校验
+    bytes = 0;
+    for (const auto& f : lop2Frames) bytes += f.size();
+    base = timeIt(rounds, [&] { for (const auto& f : lop2Frames) sink += crc16_modbus_portable(0xFFFF, f.data(), f.size() - 2); });
+    fast = timeIt(rounds, [&] { for (const auto& f : lop2Frames) sink += crc16_modbus(f.data(), f.size() - 2); });
+    report("lop2 crc16 per-frame", bytes, rounds, base, fast);
+
+    // 3) 整块归档数据 CRC (批量复核)
+    vector<uint8_t> archive;
+    for (const auto& f : lop2Frames) archive.insert(archive.end(), f.begin(), f.end());
+    base = timeIt(rounds, [&] { sink += crc16_modbus_portable(0xFFFF, archive.data(), archive.size()); });
+    fast = timeIt(rounds, [&] { sink += crc16_modbus(archive.data(), archive.size()); });
+    report("archive crc16 bulk", archive.size(), rounds, base, fast);
+
+    if (crc16_modbus_portable(0xFFFF, archive.data(), archive.size()) != crc16_modbus(archive.data(), archive.size())) {
+        cerr << "crc16 mismatch between implementations!" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * 数据库插入基准：在与 dbThread 相同的批量事务(默认 50 行/事务)下比较
+ *   1) 每行 prepare/finalize(旧写法)
+ *   2) 预编译语句 reset + 重新绑定
+ *   3) LOP1Database::frame1_insert 端到端(含报警边沿记录)
+ * 的行/秒。用法: db_insert_bench [临时库路径] [行数] [每事务行数]
+ */
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <sqlite3.h>
+
+#include "lop1_database_fast.h"
+#include "lop1_frame1.h"
+
+using namespace std;
+
+static const char* INSERT_SQL = R"(
+    INSERT INTO lop1_frame1
+    (device_id, frame, rpm1, oil_pressure, freshwater_temp, a排排温, b排排温, 齿油温, 齿油压, 海水压, alarm_bits, alarm_bits_hi, received_time, rx_time_ns, rx_mono_ns)
+    VALUES ('LOP1_frame1', ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+)";
+
+// 构造一帧校验正确的第一种帧
+static void synthFrame1(uint8_t* f) {
+    f[0] = 0xFA;
+    f[1] = 0xF5;
+    f[2] = 0x00;
+    f[3] = 35;
+    for (int i = 4; i < 35; ++i) f[i] = uint8_t(rand());
+    // 报警位实际很少变化，这里保持全 0，只在 main 中偶尔置位产生边沿
+    for (int i = LOP1Frame1Parser::ALARM_BYTE; i < LOP1Frame1Parser::ALARM_BYTE + LOP1Frame1Parser::ALARM_BYTES; ++i) f[i] = 0;
+    f[32] = 0;
+    uint8_t sum = 0;
+    for (int i = 0; i < 35; ++i) sum += f[i];
+    f[32] = uint8_t(-sum);
+}
+
+// 旧写法和预编译写法共用的绑定，参数值相同，只比较语句编译的开销
+static void bindRow(sqlite3_stmt* stmt, const LOP1Frame1Data& d) {
+    sqlite3_bind_blob(stmt, 1, d.ram_frame, sizeof(d.ram_frame), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, d.rpm);
+    sqlite3_bind_double(stmt, 3, d.oilPressure);
+    sqlite3_bind_double(stmt, 4, d.freshwatertemp);
+    sqlite3_bind_int(stmt, 5, d.Arowtemp);
+    sqlite3_bind_int(stmt, 6, d.Browtemp);
+    sqlite3_bind_double(stmt, 7, d.toothoiltemp);
+    sqlite3_bind_double(stmt, 8, d.toothoilpressure);
+    sqlite3_bind_double(stmt, 9, d.Seawaterpressure);
+    sqlite3_bind_int64(stmt, 10, int64_t(d.alarmBits.lo));
+    sqlite3_bind_int64(stmt, 11, int64_t(d.alarmBits.hi));
+    sqlite3_bind_text(stmt, 12, "2024-01-01 00:00:00.000", -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 13, d.rxRealNs);
+    sqlite3_bind_int64(stmt, 14, d.rxMonoNs);
+}
+
+template <typename Fn>
+static double timeBatches(sqlite3* db, size_t rows, size_t batch, Fn insertRow) {
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < rows; i += batch) {
+        sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+        for (size_t j = i; j < i + batch && j < rows; ++j) insertRow(j);
+        sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    }
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration<double>(t1 - t0).count();
+}
+
+static void report(const char* name, size_t rows, double sec) {
+    cout << name << ": " << size_t(rows / sec) << " rows/s (" << sec * 1e6 / rows << " us/row)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string dbPath = argc > 1 ? argv[1] : "/tmp/db_insert_bench.db";
+    size_t rows = argc > 2 ? size_t(atol(argv[2])) : 20000;
+    size_t batch = argc > 3 ? size_t(atol(argv[3])) : 50;
+    if (batch == 0) batch = 1;
+
+    remove(dbPath.c_str());
+    remove((dbPath + "-wal").c_str());
+    remove((dbPath + "-shm").c_str());
+
+    // 预先解析好所有帧，计时只包含写库部分
+    LOP1Frame1Parser parser;
+    vector<LOP1Frame1Data> frames(1024);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        uint8_t buf[35];
+        synthFrame1(buf);
+        if (i >= frames.size() / 2) {
+            buf[LOP1Frame1Parser::ALARM_BYTE + 4] = 0x01;   // 每轮一次出现、一次消失
+            buf[32] -= 0x01;
+        }
+        parser.parse(buf, frames[i], rxTimestampNow());
+    }
+
+    cout << "sqlite " << sqlite3_libversion() << ", rows " << rows << ", batch " << batch << endl;
+
+    // 建表并打开 WAL(与正式程序一致)
+    LOP1Database lop1(dbPath);
+    lop1.frame1_init();
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
+        cerr << "open " << dbPath << " failed" << endl;
+        return 1;
+    }
+    sqlite3_busy_timeout(db, 1000);
+
+    // 1) 每行编译一次
+    double perRow = timeBatches(db, rows, batch, [&](size_t i) {
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, INSERT_SQL, -1, &stmt, nullptr);
+        bindRow(stmt, frames[i % frames.size()]);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    });
+    report("prepare per row ", rows, perRow);
+
+    // 2) 编译一次，reset 复用
+    sqlite3_stmt* cached = nullptr;
+    sqlite3_prepare_v2(db, INSERT_SQL, -1, &cached, nullptr);
+    double reused = timeBatches(db, rows, batch, [&](size_t i) {
+        bindRow(cached, frames[i % frames.size()]);
+        sqlite3_step(cached);
+        sqlite3_reset(cached);
+        sqlite3_clear_bindings(cached);
+    });
+    sqlite3_finalize(cached);
+    report("cached statement", rows, reused);
+    cout << "statement cache speedup x" << perRow / reused << endl;
+    sqlite3_close(db);
+
+    // 3) 端到端
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < rows; i += batch) {
+        lop1.beginTransaction();
+        for (size_t j = i; j < i + batch && j < rows; ++j) {
+            lop1.frame1_insert(frames[j % frames.size()], 35);
+        }
+        lop1.commitTransaction();
+    }
+    auto t1 = chrono::steady_clock::now();
+    report("LOP1Database    ", rows, chrono::duration<double>(t1 - t0).count());
+    return 0;
+}
@@ -5,7 +5,9 @@
 #include <condition_variable>
 #include <vector>
 #include <memory>
+#include <cstring>
 #include "lop1.h"
+#include "serial_reactor.h"
 #include "lop1_frame1.h"
 #include "lop1_frame2.h"
 #include "lop1_database_fast.h"
@@ -13,11 +15,12 @@
 std::mutex db_mutex;  //全局锁保护数据库写入
 
 
-enum FrameType { FRAME1, FRAME2 };
-
+// 定长结构按值入队，收帧路径不分配堆内存
 struct FrameTask {
     FrameType type;
-    std::vector<uint8_t> data;
+    int len;
+    uint8_t data[FaF5Parser::MAX_FRAME];
+    RxTimestamp rx;     // 帧到达时间，随帧一起排队
 };
 
 class FrameQueue {
@@ -48,26 +51,22 @@ class FrameQueue {
         std::condition_variable cond_;
 };
 
-void receiveThread(Lop1& lop, FrameType type, size_t frameLen, FrameQueue& queue) {
-    while (true) {
-        std::vector<uint8_t> buffer(frameLen);
-        bool ok = false;
-
-        if (type == FRAME1) {
-            ok = lop.receiveData1(buffer.data());
-        } else if (type == FRAME2) {
-            ok = lop.receiveData2(buffer.data());
+// 把端口收到的数据喂给分帧器，取出所有完整帧入队(两种帧均可)
+void onPortData(Lop1& lop, FrameQueue& queue, const uint8_t* data, int len, const RxTimestamp& rx) {
+    while (len > 0) {
+        int n = lop.feedData(data, len, rx);
+        data += n;
+        len -= n;
+
+        FrameView view;
+        while (lop.extractAny(view)) {
+            FrameTask task;
+            task.type = view.type;
+            task.len = view.len;
+            memcpy(task.data, view.data, view.len);
+            task.rx = view.rx;
+            queue.push(task);
         }
-
-        if (ok) {
-            //std::cout << "[Receive] Frame " << (type == FRAME1 ? "1" : "2") << " received." << std::endl;
-            queue.push({type, std::move(buffer)}); // move buffer, avoid shallow copy
-        } else {
-            //std::cerr << "[Receive] Frame " << (type == FRAME1 ? "1" : "2") << " failed to receive." << std::endl;
-        }
-
-        // 可选延时防止过载
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
 
@@ -97,13 +96,13 @@ void dbThread(FrameQueue& queue, LOP1Database& db) {
         for (const auto& task : batch) {
             if (task.type == FRAME1) {
                 LOP1Frame1Data data1;
-                if (parser1.parse(task.data.data(), data1)) {
-                    db.frame1_insert(data1, task.data.size());
+                if (parser1.parse(task.data, data1, task.rx)) {
+                    db.frame1_insert(data1, task.len);
                 }
             } else if (task.type == FRAME2) {
                 LOP1Frame2Data data2;
-                if (parser2.parse(task.data.data(), data2)) {
-                    db.frame2_insert(data2, task.data.size());
+                if (parser2.parse(task.data, data2, task.rx)) {
+                    db.frame2_insert(data2, task.len);
                 }
             }
         }
@@ -133,12 +132,19 @@ int main() {
 
     std::cout << "Initialization successful, start accepting" << std::endl;
 
-    std::thread recv1(receiveThread, std::ref(lop1a), FRAME1, 35, std::ref(queue));
-    std::thread recv2(receiveThread, std::ref(lop1b), FRAME2, 32, std::ref(queue));
+    // 一个 epoll 线程服务两个串口，数据到达即分帧，无需轮询延时
+    SerialReactor reactor;
+    reactor.addPort(lop1a.port(), [&](const uint8_t* data, int len, const RxTimestamp& rx) {
+        onPortData(lop1a, queue, data, len, rx);
+    });
+    reactor.addPort(lop1b.port(), [&](const uint8_t* data, int len, const RxTimestamp& rx) {
+        onPortData(lop1b, queue, data, len, rx);
+    });
+
+    std::thread recv(&SerialReactor::run, &reactor);
     std::thread writer(dbThread, std::ref(queue), std::ref(db));
 
-    recv1.join();
-    recv2.join();
+    recv.join();
     writer.join();
 
     return 0;
@@ -1,13 +1,21 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 #include "lop2.h"
+#include "modbus_poll_scheduler.h"
 #include "lop2_frame.h"
 #include "lop2_database.h"
+#include "frame_json.h"
 
 using namespace std;
 
+// 写库队列上限，写库长时间卡住(SD 卡慢、检查点)时丢弃最旧的帧并计数，内存不再增长
+static const size_t WRITE_QUEUE_LIMIT = 1000;
+
 int main() {
     // 设备名称和波特率
     std::string deviceName = "/dev/ttyS3"; // 根据实际情况修改
@@ -26,78 +34,99 @@ int main() {
     LOP2Database lop2database("/media/udisk0/test.db");
     lop2database.frame_init();
 
-    //uint8_t buffer[65];
-
     // 创建帧解析器对象
     LOP2FrameParser parser;
     // 用于存储解析结果的结构体
     LOP2FrameData frameData; 
+    // 最近一帧和最近一次转速，供主线程定时打印
+    std::mutex latestMutex;
+    LOP2FrameData latest;
+    bool hasLatest = false;
+    int latestRpm = -1;
 
-    // 循环发送命令和接收数据
-    while (true) {
-        // 发送命令
-        if (!lop2.sendcommand()) {
-            std::cerr << "Failed to send command." << std::endl;
-            return 1;
+    // 写库线程：轮询回调只把帧入队，SQLite 的提交和 fsync 不会推迟下一次轮询
+    std::mutex queueMutex;
+    std::condition_variable queueCond;
+    std::deque<LOP2FrameData> writeQueue;
+    unsigned long dropped = 0;
+    std::thread writer([&] {
+        std::deque<LOP2FrameData> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCond.wait(lock, [&] { return !writeQueue.empty(); });
+                batch.swap(writeQueue);
+            }
+            for (const LOP2FrameData& data : batch) {
+                if (lop2database.frame_insert(data, 65) == -1) {
+                    std::cerr << "Failed to insert raw frame." << std::endl;
+                }
+            }
+            batch.clear();
         }
+    });
 
-        // 接收数据
-        uint8_t buffer[65];
-        if (!lop2.receiveData(buffer)) {
-            std::cerr << "Failed to receive data." << std::endl;
-            return 1;
+    // 轮询调度：从站1 保持寄存器 0x0000 起 30 个(整帧)，周期 500ms，解析后入库；
+    // 转速寄存器 0x0000 变化快，单独一块 100ms 轮询，只更新显示。
+    // 两块按截止时间交替占用总线，各自的期望/实际频率见统计
+    ModbusPollScheduler scheduler(lop2.modbus());
+    scheduler.addTask(0x01, ModbusRtuMaster::FC_READ_HOLDING, 0x0000, 30, 500,
+                      [&](const PollResult& result) {
+        if (result.status != MODBUS_OK) {
+            std::cerr << "Poll failed: " << modbusStatusString(result.status) << std::endl;
+            return;
         }
-
-        // 打印接收到的数据
-        //lop2.printReceivedData(buffer);
-
-        // 验证帧的有效性
-        if (lop2.validateFrame(buffer)) {
-            std::cout << "Received frame is valid." << std::endl;
-            // 解析有效帧
-            if (parser.parse(buffer, frameData)) {
-                // 打印解析结果
-                /*
-                std::cout << "RPM: " << frameData.rpm << " rpm" << std::endl;
-                std::cout << "Runtime: " << frameData.runtime << " h" << std::endl;
-                std::cout << "Inside Air Temp: " << frameData.insideairtemp << " ℃" << std::endl;
-                std::cout << "Oil Temp: " << frameData.oiltemp << " ℃" << std::endl;
-                std::cout << "Fresh Water Temp: " << frameData.freashwatertemp << " ℃" << std::endl;
-                std::cout << "A Row Temp: " << frameData.Arowtemp << " ℃" << std::endl;
-                std::cout << "B Row Temp: " << frameData.Browtemp << " ℃" << std::endl;
-                std::cout << "U Phase Temp: " << frameData.Uphasetemp << " ℃" << std::endl;
-                std::cout << "V Phase Temp: " << frameData.Vphasetemp << " ℃" << std::endl;
-                std::cout << "W Phase Temp: " << frameData.Wphasetemp << " ℃" << std::endl;   
-                std::cout << "Front Bearing Temp: " << frameData.frontbearingtemp << " ℃" << std::endl;
-                std::cout << "Rear Bearing Temp: " << frameData.rearbearingtemp << " ℃" << std::endl;            
-                std::cout << "Inlet Air Temp: " << frameData.inletairtemp << " ℃" << std::endl;
-                std::cout << "Outlet Air Temp: " << frameData.outletairtemp << " ℃" << std::endl;
-                std::cout << "Oil Pressure: " << frameData.oilpressure << " MPa" << std::endl;
-                std::cout << "Air Pressure: " << frameData.airpressure << " MPa" << std::endl;
-                std::cout << "Fuel Pressure: " << frameData.fuelpressure << " MPa" << std::endl;
-
-                // 打印激活的报警信息
-                std::cout << "Active Alarms:" << std::endl;
-                for (const auto& alarm : frameData.activeAlarms) {
-                    std::cout << "warning:" << alarm << std::endl;
-                }
-                */
-                // 写入数据库
-                long rawId = lop2database.frame_insert(frameData, 65);
-                if (rawId == -1) {
-                    std::cerr << "Failed to insert raw frame." << std::endl;
-                    continue;
-                }
-            } else {
-                std::cerr << "Failed to parse frame." << std::endl;
+        // 应答帧 CRC 已由主站校验，直接解析
+        if (result.frameLen != 65 || !parser.parse(result.frame, frameData, result.rx)) {
+            std::cerr << "Failed to parse frame." << std::endl;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (writeQueue.size() >= WRITE_QUEUE_LIMIT) {
+                writeQueue.pop_front();
+                ++dropped;
             }
-        } else {
-            std::cout << "Received frame is invalid." << std::endl;
+            writeQueue.push_back(frameData);
         }
+        queueCond.notify_one();
+        std::lock_guard<std::mutex> lock(latestMutex);
+        latest = frameData;
+        hasLatest = true;
+    });
+    scheduler.addTask(0x01, ModbusRtuMaster::FC_READ_HOLDING, 0x0000, 1, 100,
+                      [&](const PollResult& result) {
+        if (result.status != MODBUS_OK) return;
+        std::lock_guard<std::mutex> lock(latestMutex);
+        latestRpm = result.regs[0];
+    });
+
+    std::thread poller(&ModbusPollScheduler::run, &scheduler);
 
-        // 等待 500ms
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    // 每 10s 打印一次期望/实际轮询频率
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        for (const auto& st : scheduler.stats()) {
+            std::cout << "slave " << int(st.slave) << " reg " << st.addr << "+" << st.count
+                      << ": requested " << st.requestedHz << " Hz, achieved " << st.achievedHz
+                      << " Hz, ok " << st.ok << ", failed " << st.failed
+                      << ", missed " << st.missed << std::endl;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            std::cout << "write queue " << writeQueue.size() << ", dropped " << dropped << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(latestMutex);
+        if (latestRpm >= 0) {
+            std::cout << "rpm: " << latestRpm << std::endl;
+        }
+        if (hasLatest) {
+            Json::FastWriter writer;
+            std::cout << "latest: " << writer.write(frameToJson(LOP2_FRAME_FIELDS, latest));
+        }
     }
 
+    poller.join();
+    writer.join();
     return 0;
 }
\ No newline at end of file
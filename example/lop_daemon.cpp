@@ -0,0 +1,100 @@
+/*
+ * 采集守护进程：一个进程内运行全部串口采集(FA F5 与 Modbus RTU)、唯一的写库线程和网页数据接口。
+ * 采集线程每解码一帧同时更新内存中的最新值和写库队列，
+ * 实时接口直接读内存，/ws/realtime 在新帧到达时推送变化的字段，
+ * 历史查询走同一个数据库文件，不再有多进程争用 SQLite。
+ * 用法: lop_daemon [描述文件] [HTTP 端口]，默认 /userdata/device_profile.json 8080
+ */
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <cstdlib>
+#include "device_profile.h"
+#include "decode_program.h"
+#include "profile_ports.h"
+#include "profile_database.h"
+#include "profile_writer.h"
+#include "latest_store.h"
+#include "realtime_hub.h"
+#include "read_pool.h"
+#include "http_service.h"
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "/userdata/device_profile.json";
+    unsigned short port = argc > 2 ? (unsigned short)atoi(argv[2]) : 8080;
+
+    DeviceProfile profile;
+    std::vector<DecodeProgram> programs;
+    std::string err;
+    if (!loadDeviceProfile(path, profile, err) || !compileDeviceProfile(profile, programs, err)) {
+        std::cerr << "Invalid device profile: " << err << std::endl;
+        return -1;
+    }
+    std::cout << "Profile " << profile.name << ": " << profile.frames.size() << " frames, "
+              << profile.ports.size() << " ports, database " << profile.database << std::endl;
+
+    ProfileDatabase db(profile.database);
+    if (!db.init(profile)) {
+        std::cerr << "Failed to initialize database " << profile.database << std::endl;
+        return -1;
+    }
+
+    ProfilePorts ports(profile, programs);
+    if (!ports.open()) {
+        return -1;
+    }
+
+    LatestStore latest(profile);
+    RealtimeHub hub(latest);
+    ProfileWriter writer(db);
+    writer.onStored([&](const DecodedFrame& frame, long rowId) {
+        latest.stored(frame.frame, frame.rx.monoNs, rowId);
+    });
+    writer.start();
+    ports.start([&](const DecodedFrame& frame) {
+        latest.update(frame);
+        hub.publish(frame);
+        writer.push(frame);
+    });
+
+    HttpService http(port, profile.database, &latest, &hub);
+
+    // 每 10s 打印一次写库和丢弃数量、Modbus 轮询频率和查询连接池等待情况；
+    // 线程读 writer、ports、http，退出时先停止并 join，再销毁它们
+    std::mutex statsMutex;
+    std::condition_variable statsCond;
+    bool statsStop = false;
+    std::thread stats([&] {
+        std::unique_lock<std::mutex> lock(statsMutex);
+        while (!statsCond.wait_for(lock, std::chrono::seconds(10), [&] { return statsStop; })) {
+            std::cout << "frames written: " << writer.written() << ", dropped: " << writer.dropped() << std::endl;
+            for (const auto& st : ports.pollStats()) {
+                std::cout << "slave " << int(st.slave) << " reg " << st.addr << "+" << st.count
+                          << ": requested " << st.requestedHz << " Hz, achieved " << st.achievedHz
+                          << " Hz, ok " << st.ok << ", failed " << st.failed
+                          << ", missed " << st.missed << std::endl;
+            }
+            ReadPool::Stats pool = http.readPool().stats();
+            std::cout << "read pool: " << pool.open << " open, " << pool.leases << " leases, waited " << pool.waited
+                      << " (avg " << pool.waitAvgUs << " us, max " << pool.waitMaxUs << " us), timeouts "
+                      << pool.timeouts << ", statements hit " << pool.stmtHits << " miss " << pool.stmtMisses
+                      << std::endl;
+        }
+    });
+
+    // 网页接口在主线程运行，收到 SIGINT/SIGTERM 返回后停止采集，写完队列中的帧再退出
+    int rc = http.run();
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        statsStop = true;
+    }
+    statsCond.notify_one();
+    stats.join();
+    ports.stop();
+    ports.join();
+    writer.stop();
+    return rc;
+}
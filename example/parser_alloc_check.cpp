@@ -0,0 +1,88 @@
+/*
+ * 解析器零分配检查：替换全局 operator new 计数，
+ * 对三种帧各解析若干次(报警位随机)，期间堆分配次数必须为 0。
+ * 用法: parser_alloc_check [每种帧解析次数]，失败时返回 1
+ */
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+
+#include "lop1_frame1.h"
+#include "lop1_frame2.h"
+#include "lop2_frame.h"
+
+using namespace std;
+
+static atomic<long> allocCount(0);
+
+void* operator new(size_t size) {
+    allocCount.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+static void randomFrame(uint8_t* buf, int len) {
+    for (int i = 0; i < len; ++i) buf[i] = uint8_t(rand());
+}
+
+// 解析 rounds 次，返回期间的分配次数
+template <typename Parser, typename Data>
+static long countAllocs(Parser& parser, int frameLen, int rounds, long& activeTotal) {
+    uint8_t buf[65];
+    Data data;
+    long before = allocCount.load();
+    for (int r = 0; r < rounds; ++r) {
+        randomFrame(buf, frameLen);
+        parser.parse(buf, data, rxTimestampNow());
+        activeTotal += data.activeAlarmCount;
+    }
+    return allocCount.load() - before;
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 100000;
+
+    LOP1Frame1Parser p1;
+    LOP1Frame2Parser p2;
+    LOP2FrameParser p3;
+    long active1 = 0, active2 = 0, active3 = 0;
+
+    long a1 = countAllocs<LOP1Frame1Parser, LOP1Frame1Data>(p1, 35, rounds, active1);
+    long a2 = countAllocs<LOP1Frame2Parser, LOP1Frame2Data>(p2, 32, rounds, active2);
+    long a3 = countAllocs<LOP2FrameParser, LOP2FrameData>(p3, 65, rounds, active3);
+
+    cout << "lop1_frame1: " << a1 << " allocs, " << active1 << " alarms" << endl;
+    cout << "lop1_frame2: " << a2 << " allocs, " << active2 << " alarms" << endl;
+    cout << "lop2_frame : " << a3 << " allocs, " << active3 << " alarms" << endl;
+
+    // 解析结果可按值拷贝，报警文本指针仍指向静态表
+    uint8_t buf[35];
+    memset(buf, 0, sizeof(buf));
+    buf[LOP1Frame1Parser::ALARM_BYTE] = 0x02;
+    LOP1Frame1Data src;
+    p1.parse(buf, src);
+    LOP1Frame1Data copy = src;
+    if (copy.activeAlarmCount != 1 || copy.activeAlarms[0] != LOP1Frame1Parser::alarmLabel(1)) {
+        cerr << "copied frame lost alarm view" << endl;
+        return 1;
+    }
+
+    if (a1 || a2 || a3) {
+        cerr << "FAIL: parse() allocated on the heap" << endl;
+        return 1;
+    }
+    cout << "OK: parse() is allocation-free" << endl;
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * 描述文件解码校验：用描述文件编译出的解码程序与手写解析器解码同一批随机帧，
+ * 逐字段比较结果(必须逐位一致)并比较两者耗时。
+ * 用法: profile_decode_check [描述文件] [每种帧次数]，不一致时返回 1
+ */
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "device_profile.h"
+#include "decode_program.h"
+#include "lop1_frame1.h"
+#include "lop1_frame2.h"
+#include "lop2_frame.h"
+
+using namespace std;
+typedef chrono::steady_clock Clock;
+
+static double elapsedNs(Clock::time_point start, int rounds) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / rounds;
+}
+
+// 比较一种帧，返回不一致的字段数
+template <typename Parser, typename Data, size_t N>
+static long check(const DeviceProfile& profile, const vector<DecodeProgram>& programs, const char* table,
+                  const FieldDesc<Data> (&fields)[N], int rounds) {
+    int id = profile.findFrame(table);
+    if (id < 0) {
+        cout << table << ": not in profile, skipped" << endl;
+        return 0;
+    }
+    const FrameSpec& spec = profile.frames[id];
+    const DecodeProgram& program = programs[id];
+
+    // 手写描述表的每个字段在描述文件中的位置
+    int slot[N];
+    for (size_t i = 0; i < N; ++i) {
+        slot[i] = -1;
+        for (size_t j = 0; j < spec.fields.size(); ++j) {
+            if (spec.fields[j].column == fields[i].column) slot[i] = int(j);
+        }
+        if (slot[i] < 0) {
+            cerr << table << "." << fields[i].column << ": missing in profile" << endl;
+            return 1;
+        }
+    }
+
+    Parser parser;
+    vector<uint8_t> frames(size_t(rounds) * Parser::FRAME_LEN);
+    for (auto& b : frames) b = uint8_t(rand());
+
+    long mismatches = 0;
+    Data data;
+    DecodedFrame decoded;
+    RxTimestamp rx = rxTimestampNow();
+    for (int r = 0; r < rounds; ++r) {
+        const uint8_t* buf = &frames[size_t(r) * Parser::FRAME_LEN];
+        parser.parse(buf, data, rx);
+        program.decode(buf, rx, decoded);
+        for (size_t i = 0; i < N; ++i) {
+            double expect = fields[i].isInteger() ? double(data.*(fields[i].u16)) : double(data.*(fields[i].f32));
+            if (memcmp(&expect, &decoded.values[slot[i]], sizeof(double)) != 0) ++mismatches;
+        }
+        if (decoded.alarmBits.lo != data.alarmBits.lo || decoded.alarmBits.hi != data.alarmBits.hi) ++mismatches;
+    }
+    for (int bit = 0; bit < Parser::ALARM_BITS; ++bit) {
+        if (strcmp(program.alarms().label(bit), Parser::alarmLabel(bit)) != 0) ++mismatches;
+    }
+
+    // 计时：手写解析器(含报警文本收集) 与 解码程序(字段 + 报警位)
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) parser.parse(&frames[size_t(r) * Parser::FRAME_LEN], data, rx);
+    double handNs = elapsedNs(t0, rounds);
+    t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) decodeFields(fields, &frames[size_t(r) * Parser::FRAME_LEN], data);
+    double handFieldsNs = elapsedNs(t0, rounds);
+    t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) program.decode(&frames[size_t(r) * Parser::FRAME_LEN], rx, decoded);
+    double programNs = elapsedNs(t0, rounds);
+    t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) program.decodeValues(&frames[size_t(r) * Parser::FRAME_LEN], decoded.values);
+    double fieldsNs = elapsedNs(t0, rounds);
+
+    cout << table << ": " << mismatches << " mismatches; ns/frame hand-written " << handNs
+         << " (fields " << handFieldsNs << "), profile " << programNs << " (fields " << fieldsNs << ")" << endl;
+    return mismatches;
+}
+
+int main(int argc, char* argv[]) {
+    string path = argc > 1 ? argv[1] : "/userdata/device_profile.json";
+    int rounds = argc > 2 ? atoi(argv[2]) : 200000;
+
+    DeviceProfile profile;
+    vector<DecodeProgram> programs;
+    string err;
+    if (!loadDeviceProfile(path, profile, err) || !compileDeviceProfile(profile, programs, err)) {
+        cerr << "Invalid device profile: " << err << endl;
+        return 1;
+    }
+
+    long bad = 0;
+    bad += check<LOP1Frame1Parser>(profile, programs, "lop1_frame1", LOP1_FRAME1_FIELDS, rounds);
+    bad += check<LOP1Frame2Parser>(profile, programs, "lop1_frame2", LOP1_FRAME2_FIELDS, rounds);
+    bad += check<LOP2FrameParser>(profile, programs, "lop2_frame", LOP2_FRAME_FIELDS, rounds);
+    if (bad) {
+        cerr << "FAIL: profile decode differs from hand-written parsers" << endl;
+        return 1;
+    }
+    cout << "OK: profile decode matches hand-written parsers" << endl;
+    return 0;
+}
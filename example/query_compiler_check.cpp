@@ -0,0 +1,319 @@
+/*
+ * 查询编译校验：在临时库上检查 compileQuery
+ *   1) 表名、字段、运算符、排序和条件值里夹带 SQL 时要么拒绝，要么只作为绑定值出现，
+ *      执行后表和库结构不变；
+ *   2) 同一查询翻页时(LIMIT/OFFSET 与游标两种)各页编译出的 SQL 文本相同，只有绑定值不同；
+ *   3) 报警表名带单引号时，报警文本列仍按该表的报警表解析，表名不破坏 SQL；
+ *   4) 时间有重复时用 handleQuery 按游标逐页取完(升序/降序，有无时间范围，页边界落在同一时间的行中间)，
+ *      结果与直接 ORDER BY received_time, id 查询的结果逐行相同，换成只含 received_time 的索引后仍相同。
+ * 用法: query_compiler_check [临时库路径]，不通过时返回 1
+ */
+#include <iostream>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sqlite3.h>
+#include <json/json.h>
+#include "query_compiler.h"
+#include "basetoweb.h"
+#include "read_pool.h"
+#include "alarm_table.h"
+
+using namespace std;
+
+static long failures = 0;
+
+static void expect(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "FAIL: " << what << endl;
+        ++failures;
+    }
+}
+
+static Json::Value parse(const string& text) {
+    Json::CharReaderBuilder builder;
+    unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    Json::Value value;
+    string err;
+    if (!reader->parse(text.data(), text.data() + text.size(), &value, &err)) {
+        cerr << "bad test request: " << text << ": " << err << endl;
+        ++failures;
+    }
+    return value;
+}
+
+static long scalar(sqlite3* db, const char* sql) {
+    sqlite3_stmt* stmt = nullptr;
+    long value = -1;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        value = long(sqlite3_column_int64(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+// 执行编译结果，返回行数，出错返回 -1
+static long run(sqlite3* db, const CompiledQuery& query) {
+    sqlite3_stmt* stmt = nullptr;
+    string err;
+    long rows = -1;
+    if (sqlite3_prepare_v2(db, query.sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK && bindQuery(stmt, query.values, err)) {
+        int rc;
+        for (rows = 0; (rc = sqlite3_step(stmt)) == SQLITE_ROW; ++rows) {}
+        if (rc != SQLITE_DONE) rows = -1;
+    }
+    sqlite3_finalize(stmt);
+    return rows;
+}
+
+// 夹带 SQL 的请求；payload 为编译通过时不能出现在 SQL 文本里的片段，rows 为编译通过时应得的行数
+struct HostileCase {
+    const char* name;
+    const char* request;
+    const char* payload;
+    long rows;
+};
+
+static const HostileCase HOSTILE[] = {
+    {"table with statement", R"({"table": "t; DROP TABLE t", "fields": ["id"]})", "DROP", 0},
+    {"table with quote", R"({"table": "t\" WHERE 1=1 --", "fields": ["id"]})", "1=1", 0},
+    {"table sqlite_master", R"({"table": "sqlite_master", "fields": ["sql"]})", "sqlite_master", 0},
+    {"table not string", R"({"table": {"t": 1}, "fields": ["id"]})", nullptr, 0},
+    {"field subquery", R"j({"table": "t", "fields": ["id, (SELECT sql FROM sqlite_master)"]})j", "sqlite_master", 0},
+    {"field with quote", R"({"table": "t", "fields": ["v\" FROM t; DROP TABLE t; --"]})", "DROP", 0},
+    {"field not string", R"({"table": "t", "fields": [{"id": 1}]})", nullptr, 0},
+    {"star with fields", R"({"table": "t", "fields": ["*", "id"]})", nullptr, 0},
+    {"op tautology", R"({"table": "t", "fields": ["id"],
+        "filter": {"conditions": [{"field": "v", "op": "= 1 OR 1", "value": "1"}]}})", "OR 1", 0},
+    {"op statement", R"({"table": "t", "fields": ["id"],
+        "filter": {"conditions": [{"field": "v", "op": "=; DROP TABLE t; --", "value": "1"}]}})", "DROP", 0},
+    {"condition field", R"({"table": "t", "fields": ["id"],
+        "filter": {"conditions": [{"field": "v = v OR 1", "op": "=", "value": "1"}]}})", "OR 1", 0},
+    {"sort field", R"({"table": "t", "fields": ["id"], "sort": {"field": "v; DROP TABLE t", "order": "ASC"}})",
+        "DROP", 0},
+    {"sort order", R"({"table": "t", "fields": ["id"], "sort": {"field": "v", "order": "DESC; DROP TABLE t"}})",
+        "DROP", 0},
+    {"cursor sort field", R"({"table": "t", "fields": ["id"], "sort": {"field": "v", "order": "ASC"},
+        "pagination": {"limit": 5, "cursor": ""}})", nullptr, 0},
+    {"cursor not hex", R"({"table": "t", "fields": ["id"], "pagination": {"limit": 5, "cursor": "' OR 1=1 --"}})",
+        "1=1", 0},
+    {"value quote", R"({"table": "t", "fields": ["id"],
+        "filter": {"conditions": [{"field": "device_id", "op": "=", "value": "x' OR '1'='1"}]}})", "'1'", 0},
+    {"value like", R"({"table": "t", "fields": ["id"],
+        "filter": {"conditions": [{"field": "device_id", "op": "like", "value": "%' OR 1=1 --"}]}})", "1=1", 0},
+    {"value not string", R"({"table": "t", "fields": ["id"],
+        "filter": {"conditions": [{"field": "v", "op": "=", "value": [1, 2]}]}})", nullptr, 0},
+    {"time range quote", R"({"table": "t", "fields": ["id"],
+        "filter": {"time_range": {"start": "2099' OR 1=1 --"}}})", "1=1", 0},
+    {"limit not number", R"({"table": "t", "fields": ["id"], "pagination": {"limit": "1; DROP TABLE t"}})",
+        "DROP", 0},
+    // 正常请求，确认上面的拒绝不是因为表本身不可查
+    {"plain", R"({"table": "t", "fields": ["id", "v"], "sort": {"field": "v", "order": "desc"},
+        "filter": {"conditions": [{"field": "device_id", "op": "LIKE", "value": "dev%"}]}})", nullptr, 1000},
+};
+
+static void checkHostile(sqlite3* db, const TableSchemas& schemas) {
+    long rowsBefore = scalar(db, "SELECT COUNT(*) FROM t;");
+    long schemaBefore = scalar(db, "PRAGMA schema_version;");
+    int rejected = 0;
+    for (const HostileCase& c : HOSTILE) {
+        CompiledQuery query;
+        string err;
+        if (!compileQuery(parse(c.request), schemas, query, err)) {
+            expect(!err.empty(), string(c.name) + ": rejected without a reason");
+            ++rejected;
+            continue;
+        }
+        expect(!c.payload || query.sql.find(c.payload) == string::npos,
+               string(c.name) + ": payload in SQL text: " + query.sql);
+        long rows = run(db, query);
+        expect(rows == c.rows, string(c.name) + ": " + to_string(rows) + " rows, expected " + to_string(c.rows));
+    }
+    expect(scalar(db, "SELECT COUNT(*) FROM t;") == rowsBefore, "table t changed");
+    expect(scalar(db, "PRAGMA schema_version;") == schemaBefore, "schema changed");
+    cout << "hostile inputs: " << sizeof(HOSTILE) / sizeof(HOSTILE[0]) << " cases, " << rejected << " rejected" << endl;
+}
+
+// 两页请求编译出的 SQL 文本应相同，绑定值应不同
+static void checkSamePages(const TableSchemas& schemas, const char* name, const string& first, const string& second) {
+    CompiledQuery a, b;
+    string err;
+    if (!compileQuery(parse(first), schemas, a, err) || !compileQuery(parse(second), schemas, b, err)) {
+        expect(false, string(name) + ": " + err);
+        return;
+    }
+    expect(a.sql == b.sql, string(name) + ": SQL differs:\n  " + a.sql + "\n  " + b.sql);
+    bool sameValues = a.values.size() == b.values.size();
+    for (size_t i = 0; sameValues && i < a.values.size(); ++i) {
+        sameValues = a.values[i].isInt == b.values[i].isInt && a.values[i].i == b.values[i].i
+                     && a.values[i].text == b.values[i].text;
+    }
+    expect(!sameValues, string(name) + ": pages bind the same values");
+}
+
+static void checkPaging(const TableSchemas& schemas) {
+    const string range = R"("filter": {"time_range": {"start": "2023-11-14 22:13:20", "end": "2023-11-14 22:20:00"},
+        "conditions": [{"field": "v", "op": ">=", "value": "3"}]})";
+    checkSamePages(schemas, "offset pages",
+                   R"({"table": "t", "fields": ["id", "v"], "sort": {"field": "received_time", "order": "DESC"},
+                       "pagination": {"limit": 50, "offset": 0}, )" + range + "}",
+                   R"({"table": "t", "fields": ["id", "v"], "sort": {"field": "received_time", "order": "DESC"},
+                       "pagination": {"limit": 50, "offset": 150}, )" + range + "}");
+    // 游标页：首页不带游标，第 2、3 页的游标不同
+    for (const char* order : {"ASC", "DESC"}) {
+        string head = string(R"({"table": "t", "fields": ["id", "v"], "sort": {"field": "received_time", "order": ")")
+                    + order + R"("}, )" + range + R"(, "pagination": {"limit": 50, "cursor": ")";
+        checkSamePages(schemas, (string("cursor pages ") + order).c_str(),
+                       head + encodeCursor("2023-11-14 22:15:00.000", "120") + R"("}})",
+                       head + encodeCursor("2023-11-14 22:16:40.000", "170") + R"("}})");
+    }
+    cout << "paging: SQL text checked" << endl;
+}
+
+// 直接按 (received_time, id) 排序查询的 id 序列
+static vector<string> expectedIds(sqlite3* db, const string& where, const char* order) {
+    string sql = "SELECT id FROM t" + (where.empty() ? "" : " WHERE " + where) + " ORDER BY received_time " + order
+               + ", id " + order + ";";
+    vector<string> ids;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) ids.push_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+    return ids;
+}
+
+// 用 next_cursor 逐页取完，每页 7 行(每 3 行同一时间，页边界会落在同一时间的行中间)
+static void checkCursorWalk(sqlite3* db, const string& path) {
+    struct Range {
+        const char* start;
+        const char* end;
+    };
+    // 边界恰好等于某一时间，该时间的 3 行都应在范围内
+    const Range ranges[] = {{"", ""}, {"2023-11-14 22:14:00.000", ""}, {"", "2023-11-14 22:17:00.000"},
+                            {"2023-11-14 22:14:00.000", "2023-11-14 22:17:00.000"}};
+    const int pageSize = 7;
+
+    ReadPool pool(path, 1, registerAlarmFunctions);
+    BaseToWeb web(path, nullptr, &pool);
+    int walks = 0;
+    for (const char* order : {"ASC", "DESC"}) {
+        for (const Range& range : ranges) {
+            Json::Value request;
+            request["table"] = "t";
+            request["fields"].append("id");
+            request["sort"]["field"] = "received_time";
+            request["sort"]["order"] = order;
+            string where;
+            if (*range.start) {
+                request["filter"]["time_range"]["start"] = range.start;
+                where = string("received_time >= '") + range.start + "'";
+            }
+            if (*range.end) {
+                request["filter"]["time_range"]["end"] = range.end;
+                where += string(where.empty() ? "" : " AND ") + "received_time <= '" + range.end + "'";
+            }
+            request["pagination"]["limit"] = pageSize;
+            request["pagination"]["cursor"] = "";
+
+            string name = string("cursor walk ") + order + " [" + range.start + ", " + range.end + "]";
+            vector<string> expected = expectedIds(db, where, order);
+            vector<string> ids;
+            for (size_t pages = 0; pages <= expected.size() / pageSize + 1; ++pages) {
+                Json::Value response = web.handleQuery(request);
+                if (response["status"].asString() != "success") {
+                    expect(response["message"].asString() == "No results found." && ids.size() == expected.size(),
+                           name + ": " + response["message"].asString());
+                    break;
+                }
+                for (const Json::Value& row : response["data"]) ids.push_back(row[0].asString());
+                if (!response.isMember("next_cursor")) break;
+                expect(response["data"].size() == Json::ArrayIndex(pageSize), name + ": short page with next_cursor");
+                request["pagination"]["cursor"] = response["next_cursor"];
+            }
+            expect(!expected.empty() && ids == expected,
+                   name + ": " + to_string(ids.size()) + " rows, expected " + to_string(expected.size()));
+            ++walks;
+        }
+    }
+    cout << "cursor walks: " << walks << " checked" << endl;
+}
+
+// 报警表名来自描述文件，带单引号时作为 alarm_text 的查找键也要原样传入
+static void checkQuotedAlarmSource(sqlite3* db) {
+    const string table = "lop' OR '1";
+    registerAlarmTable(table, make_shared<AlarmTable>(8, unordered_map<int, string>{{0, "bit0"}, {2, "bit2"}}));
+    registerAlarmFunctions(db);
+    sqlite3_exec(db,
+                 "CREATE TABLE \"lop' OR '1\" (id INTEGER PRIMARY KEY, alarm_bits INTEGER, received_time DATETIME);"
+                 "INSERT INTO \"lop' OR '1\" (alarm_bits, received_time) VALUES (5, '2023-11-14 22:13:20');",
+                 nullptr, nullptr, nullptr);
+
+    TableSchemas schemas;
+    string err;
+    CompiledQuery query;
+    Json::Value request;
+    request["table"] = table;
+    request["fields"].append(ALARM_TEXT_FIELD);
+    if (!schemas.refresh(db, err) || !compileQuery(request, schemas, query, err)) {
+        expect(false, "quoted alarm source: " + err);
+        return;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    string text;
+    if (sqlite3_prepare_v2(db, query.sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK && bindQuery(stmt, query.values, err)
+        && sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0)) {
+        text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    expect(text.find("bit0") != string::npos && text.find("bit2") != string::npos,
+           "quoted alarm source: got '" + text + "' from " + query.sql);
+    sqlite3_exec(db, "DROP TABLE \"lop' OR '1\";", nullptr, nullptr, nullptr);
+    cout << "quoted alarm source: " << text << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string path = argc > 1 ? argv[1] : "/tmp/query_compiler_check.db";
+    remove(path.c_str());
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+        cerr << "open " << path << " failed" << endl;
+        return 1;
+    }
+    // 与采集表相同的时间列和索引，每 3 行同一时间
+    sqlite3_exec(db,
+                 "CREATE TABLE t (id INTEGER PRIMARY KEY AUTOINCREMENT, device_id TEXT, v INTEGER, "
+                 "received_time DATETIME);"
+                 "CREATE INDEX idx_t_time ON t(received_time DESC, id DESC);"
+                 "WITH RECURSIVE k(n) AS (SELECT 0 UNION ALL SELECT n + 1 FROM k WHERE n < 999) "
+                 "INSERT INTO t (device_id, v, received_time) "
+                 "SELECT 'dev1', n % 7, strftime('%Y-%m-%d %H:%M:%f', 1700000000 + n / 3, 'unixepoch') FROM k;",
+                 nullptr, nullptr, nullptr);
+
+    TableSchemas schemas;
+    string err;
+    if (!schemas.refresh(db, err)) {
+        cerr << "schema: " << err << endl;
+        sqlite3_close(db);
+        return 1;
+    }
+    checkHostile(db, schemas);
+    checkPaging(schemas);
+    checkQuotedAlarmSource(db);
+    checkCursorWalk(db, path);
+    // 旧库的时间索引不含 id，同一时间的行由 SQLite 另行排序，结果应相同
+    sqlite3_exec(db, "DROP INDEX idx_t_time; CREATE INDEX idx_t_time ON t(received_time DESC);", nullptr, nullptr,
+                 nullptr);
+    checkCursorWalk(db, path);
+    sqlite3_close(db);
+
+    if (failures) {
+        cerr << "FAIL: " << failures << " query compiler checks failed" << endl;
+        return 1;
+    }
+    cout << "OK: query compiler checks passed" << endl;
+    return 0;
+}
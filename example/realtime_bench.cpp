@@ -0,0 +1,207 @@
+/*
+ * 实时接口基准：同一请求分别走
+ *   1) LatestStore::latest 取一帧
+ *   2) BaseToWeb::handleRealtime 从内存应答
+ *   3) BaseToWeb::handleRealtime 查 SQLite(内存尚无数据时的回退路径)
+ * 以及历史查询 BaseToWeb::handleQuery 每次打开只读连接与从 ReadPool 借连接的耗时，
+ * 整表导出时一次生成应答与 streamQuery 逐段生成的耗时，多线程争用小连接池时的等待统计。
+ * 并在写线程不停更新时检查读者是否读到撕裂的帧(一帧内所有字节和字段取自同一个计数值)。
+ * 用法: realtime_bench [描述文件] [临时库路径] [次数]
+ */
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "device_profile.h"
+#include "decode_program.h"
+#include "profile_database.h"
+#include "latest_store.h"
+#include "basetoweb.h"
+#include "read_pool.h"
+
+using namespace std;
+
+// 构造一帧校验正确的 FA F5 帧，数据区按 k 变化
+static void synthFrame(uint8_t* f, int len, int k) {
+    memset(f, 0, len);
+    f[0] = 0xFA;
+    f[1] = 0xF5;
+    f[3] = uint8_t(len);
+    for (int i = 5; i < len - 2; ++i) f[i] = uint8_t(i * 7 + k);
+    uint8_t sum = 0;
+    for (int i = 0; i < len; ++i) sum += f[i];
+    f[len - 2] = uint8_t(-sum);
+}
+
+template <typename Fn>
+static void timeRuns(const char* name, size_t runs, Fn fn) {
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < runs; ++i) fn();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("%-28s %10.3f us/req\n", name, sec * 1e6 / runs);
+}
+
+int main(int argc, char* argv[]) {
+    string path = argc > 1 ? argv[1] : "config/device_profile.json";
+    string dbPath = argc > 2 ? argv[2] : "/tmp/realtime_bench.db";
+    size_t runs = argc > 3 ? size_t(atol(argv[3])) : 20000;
+
+    DeviceProfile profile;
+    vector<DecodeProgram> programs;
+    string err;
+    if (!loadDeviceProfile(path, profile, err) || !compileDeviceProfile(profile, programs, err)) {
+        cerr << "Invalid device profile: " << err << endl;
+        return -1;
+    }
+    int id = profile.findFrame("lop1_frame1");
+    if (id < 0) {
+        cerr << "lop1_frame1 not in profile" << endl;
+        return -1;
+    }
+    const FrameSpec& spec = profile.frames[id];
+
+    remove(dbPath.c_str());
+    string wal = dbPath + "-wal", shm = dbPath + "-shm";
+    remove(wal.c_str());
+    remove(shm.c_str());
+
+    // 库里先写 1000 帧，内存中放最后一帧
+    LatestStore store(profile);
+    {
+        ProfileDatabase db(dbPath);
+        if (!db.init(profile)) return -1;
+        uint8_t raw[DecodedFrame::MAX_FRAME];
+        DecodedFrame frame;
+        db.beginTransaction();
+        for (int k = 0; k < 1000; ++k) {
+            synthFrame(raw, spec.length, k);
+            RxTimestamp rx = {int64_t(k) * 1000000, 1700000000000000000LL + int64_t(k) * 1000000};
+            programs[id].decode(raw, rx, frame);
+            store.update(frame);
+            store.stored(id, rx.monoNs, db.insert(frame));
+        }
+        db.commitTransaction();
+    }
+
+    // 与页面默认请求一样带 id
+    Json::Value request;
+    request["table"] = spec.table;
+    request["fields"].append("id");
+    for (const FieldSpec& field : spec.fields) request["fields"].append(field.column);
+    request["fields"].append("alarm_bits");
+    request["fields"].append("received_time");
+
+    BaseToWeb fromMemory(dbPath, &store);
+    BaseToWeb fromSqlite(dbPath);
+    Json::StreamWriterBuilder w;
+    w["indentation"] = "";
+    string a = Json::writeString(w, fromMemory.handleRealtime(request));
+    string b = Json::writeString(w, fromSqlite.handleRealtime(request));
+    cout << "memory: " << a << endl;
+    cout << "sqlite: " << b << endl;
+    cout << (a == b ? "responses identical" : "RESPONSES DIFFER") << endl;
+
+    DecodedFrame out;
+    timeRuns("LatestStore::latest", runs * 10, [&] { store.latest(id, out); });
+    timeRuns("handleRealtime (memory)", runs, [&] { fromMemory.handleRealtime(request); });
+    timeRuns("handleRealtime (sqlite)", runs, [&] { fromSqlite.handleRealtime(request); });
+
+    // 历史查询：一页 50 行
+    Json::Value query = request;
+    query["sort"]["field"] = "received_time";
+    query["sort"]["order"] = "DESC";
+    query["pagination"]["offset"] = 100;
+    query["pagination"]["limit"] = 50;
+    ReadPool pool(dbPath, 2, registerAlarmFunctions);
+    BaseToWeb pooled(dbPath, nullptr, &pool);
+    string c = Json::writeString(w, fromSqlite.handleQuery(query));
+    string d = Json::writeString(w, pooled.handleQuery(query));
+    cout << (c == d ? "query responses identical" : "QUERY RESPONSES DIFFER") << endl;
+    timeRuns("handleQuery (open per req)", runs / 10, [&] { fromSqlite.handleQuery(query); });
+    timeRuns("handleQuery (read pool)", runs / 10, [&] { pooled.handleQuery(query); });
+    // 翻页时只有绑定值变化，仍命中同一条缓存语句
+    int page = 0;
+    timeRuns("handleQuery (pool, paging)", runs / 10, [&] {
+        query["pagination"]["offset"] = (page++ % 18) * 50;
+        pooled.handleQuery(query);
+    });
+    timeRuns("handleRealtime (read pool)", runs, [&] { pooled.handleRealtime(request); });
+
+    // 整表导出：一次生成完整应答与逐段生成，结果应相同
+    Json::Value all = request;
+    all["sort"] = query["sort"];
+    Json::Value parsed, ignored;
+    string text;
+    unique_ptr<QueryStream> stream = pooled.streamQuery(all, ignored);
+    while (stream && stream->next(text, 64 * 1024)) {}
+    stream.reset();
+    Json::CharReaderBuilder rb;
+    unique_ptr<Json::CharReader> reader(rb.newCharReader());
+    reader->parse(text.data(), text.data() + text.size(), &parsed, &err);
+    cout << (parsed == pooled.handleQuery(all) ? "export responses identical" : "EXPORT RESPONSES DIFFER")
+         << " (" << text.size() << " bytes)" << endl;
+    timeRuns("export (handleQuery)", runs / 1000 + 1, [&] { Json::writeString(w, pooled.handleQuery(all)); });
+    timeRuns("export (streamQuery)", runs / 1000 + 1, [&] {
+        string chunk;
+        unique_ptr<QueryStream> s = pooled.streamQuery(all, ignored);
+        while (s && s->next(chunk, 64 * 1024)) chunk.clear();
+    });
+
+    // 4 个线程争用 2 个连接
+    {
+        vector<thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.push_back(thread([&] {
+                BaseToWeb worker(dbPath, nullptr, &pool);
+                for (size_t i = 0; i < runs / 40; ++i) worker.handleQuery(query);
+            }));
+        }
+        for (thread& t : workers) t.join();
+    }
+    ReadPool::Stats ps = pool.stats();
+    cout << "read pool: " << ps.open << " open, " << ps.leases << " leases, waited " << ps.waited
+         << " (avg " << ps.waitAvgUs << " us, max " << ps.waitMaxUs << " us), timeouts " << ps.timeouts
+         << ", statements hit " << ps.stmtHits << " miss " << ps.stmtMisses << endl;
+
+    // 并发一致性：写线程每次写入字节和字段全为同一计数值的帧，读者检查整帧是否一致
+    atomic<bool> stop(false);
+    thread writer([&] {
+        DecodedFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.frame = id;
+        frame.len = spec.length;
+        frame.fieldCount = int(spec.fields.size());
+        for (uint32_t k = 0; !stop.load(memory_order_relaxed); ++k) {
+            memset(frame.raw, int(k & 0xFF), sizeof(frame.raw));
+            for (int i = 0; i < frame.fieldCount; ++i) frame.values[i] = double(k);
+            frame.alarmBits.lo = k;
+            frame.rx.realNs = int64_t(k);
+            store.update(frame);
+        }
+    });
+    size_t reads = 0, torn = 0;
+    uint32_t v0 = store.version(id);
+    // 等写线程写入第一帧，之前读到的仍是上面解码的真实帧
+    while (store.version(id) == v0) this_thread::yield();
+    auto t0 = chrono::steady_clock::now();
+    while (chrono::steady_clock::now() - t0 < chrono::seconds(2)) {
+        store.latest(id, out);
+        uint64_t k = out.alarmBits.lo;
+        bool ok = out.rx.realNs == int64_t(k);
+        for (int i = 0; ok && i < out.len; ++i) ok = out.raw[i] == uint8_t(k);
+        for (int i = 0; ok && i < out.fieldCount; ++i) ok = out.values[i] == double(k);
+        if (!ok) ++torn;
+        ++reads;
+    }
+    stop = true;
+    writer.join();
+    cout << "concurrent: " << reads << " reads, " << store.version(id) - v0 << " updates, "
+         << torn << " torn" << endl;
+    return (a == b && c == d && torn == 0) ? 0 : 1;
+}
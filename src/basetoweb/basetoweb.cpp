@@ -4,12 +4,147 @@
 #include <iostream>
 #include <sstream>
 #include <json/json.h>
+#include "lop1_frame1.h"
+#include "lop1_frame2.h"
+#include "lop2_frame.h"
+#include "latest_store.h"
+#include "db_schema.h"
+#include "read_pool.h"
+#include "query_compiler.h"
+
+// 连接池全部借出时最多等多久
+static const int QUERY_WAIT_MS = 5000;
+
+// 查表法十六进制编码：每个字节直接取两位字符
+struct HexTable {
+    char pair[256][2];
+    HexTable() {
+        static const char digits[] = "0123456789ABCDEF";
+        for (int i = 0; i < 256; ++i) {
+            pair[i][0] = digits[i >> 4];
+            pair[i][1] = digits[i & 0x0F];
+        }
+    }
+};
+static const HexTable hexTable;
+
+static std::string blobToHex(const void* blob, int len) {
+    const unsigned char* p = static_cast<const unsigned char*>(blob);
+    std::string out(size_t(len) * 2, '\0');
+    for (int i = 0; i < len; ++i) {
+        out[2 * i] = hexTable.pair[p[i]][0];
+        out[2 * i + 1] = hexTable.pair[p[i]][1];
+    }
+    return out;
+}
+
+// 报警位只以 alarm_bits 存库，文本在查询时按来源表的报警表解析
+static std::string alarmLabel(const std::string& source, int bit) {
+    const char* label = nullptr;
+    std::shared_ptr<const AlarmTable> table = findAlarmTable(source);
+    if (table) label = table->label(bit);
+    else if (source == "lop1_frame1") label = LOP1Frame1Parser::alarmLabel(bit);
+    else if (source == "lop1_frame2") label = LOP1Frame2Parser::alarmLabel(bit);
+    else if (source == "lop2_frame") label = LOP2FrameParser::alarmLabel(bit);
+    return label ? label : "未知报警 Bit" + std::to_string(bit);
+}
+
+// 报警位转 JSON 文本数组
+static std::string alarmTextJson(const std::string& source, const AlarmBits& bits) {
+    Json::Value alarms(Json::arrayValue);
+    for (int bit = 0; bit < 128; ++bit) {
+        if (bits.test(bit)) alarms.append(alarmLabel(source, bit));
+    }
+    Json::StreamWriterBuilder writerBuilder;
+    writerBuilder.settings_["emitUTF8"] = true;
+    writerBuilder.settings_["indentation"] = "";
+    return Json::writeString(writerBuilder, alarms);
+}
+
+// SQL 函数 alarm_text(source, alarm_bits, alarm_bits_hi)：报警位转 JSON 文本数组
+static void sqlAlarmText(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    const char* source = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    if (!source || sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    AlarmBits bits;
+    bits.lo = uint64_t(sqlite3_value_int64(argv[1]));
+    bits.hi = uint64_t(sqlite3_value_int64(argv[2]));
+
+    std::string text = alarmTextJson(source, bits);
+    sqlite3_result_text(ctx, text.c_str(), int(text.size()), SQLITE_TRANSIENT);
+}
+
+// SQL 函数 alarm_name(source, bit)：alarm_events 中单个报警位的文本
+static void sqlAlarmName(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    const char* source = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    if (!source) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    std::string label = alarmLabel(source, sqlite3_value_int(argv[1]));
+    sqlite3_result_text(ctx, label.c_str(), int(label.size()), SQLITE_TRANSIENT);
+}
+
+void registerAlarmFunctions(sqlite3* db) {
+    sqlite3_create_function(db, "alarm_text", 3, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, sqlAlarmText, nullptr, nullptr);
+    sqlite3_create_function(db, "alarm_name", 2, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, sqlAlarmName, nullptr, nullptr);
+}
+
+// 当前行一列的字符串值，NULL 为 "NULL"，BLOB 列转成十六进制
+static std::string columnText(sqlite3_stmt* stmt, int i) {
+    switch (sqlite3_column_type(stmt, i)) {
+    case SQLITE_NULL:
+        return "NULL";
+    case SQLITE_BLOB:
+        return blobToHex(sqlite3_column_blob(stmt, i), sqlite3_column_bytes(stmt, i));
+    default:
+        return reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+    }
+}
+
+// 执行已编译的语句并把每列转为字符串；不 finalize 语句
+static bool stepRows(sqlite3_stmt* stmt, std::vector<std::vector<std::string>>& results, std::string& err) {
+    int rc;
+    int columnCount = sqlite3_column_count(stmt);
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        std::vector<std::string> row;
+        row.reserve(columnCount);
+        for (int i = 0; i < columnCount; ++i) row.push_back(columnText(stmt, i));
+        results.push_back(row);
+    }
+    if (rc != SQLITE_DONE) err = sqlite3_errmsg(sqlite3_db_handle(stmt));
+    return rc == SQLITE_DONE;
+}
+
+static bool readRows(sqlite3* db, const std::string& sql,
+                     std::vector<std::vector<std::string>>& results, std::string& err) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        err = sqlite3_errmsg(db);
+        return false;
+    }
+    bool ok = stepRows(stmt, results, err);
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+// 读写连接在第一次需要时才打开，实时接口从内存应答时不碰数据库
+BaseToWeb::BaseToWeb(const std::string& dbPath, const LatestStore* latest, ReadPool* pool)
+    : db(nullptr), dbPath(dbPath), latest(latest), pool(pool) {
+}
 
-BaseToWeb::BaseToWeb(const std::string& dbPath) {
+bool BaseToWeb::openDb() {
+    if (db) return true;
     if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
         std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
         db = nullptr;
+        return false;
     }
+    registerAlarmFunctions(db);
+    return true;
 }
 
 BaseToWeb::~BaseToWeb() {
@@ -18,7 +153,75 @@ BaseToWeb::~BaseToWeb() {
     }
 }
 
+// 与 SQLite 把列值转成文本的格式一致：REAL 为 %!.15g，INTEGER 为十进制
+static std::string realText(double v) {
+    char buf[32];
+    sqlite3_snprintf(sizeof(buf), buf, "%!.15g", v);
+    return buf;
+}
+
+bool latestFieldText(const FrameSpec& spec, const DecodedFrame& frame,
+                     const std::string& field, std::string& text) {
+    for (size_t i = 0; i < spec.fields.size(); ++i) {
+        if (spec.fields[i].column == field) {
+            text = spec.fields[i].real ? realText(frame.values[i]) : std::to_string(int64_t(frame.values[i]));
+            return true;
+        }
+    }
+    if (field == FRAME_HEX_FIELD) text = blobToHex(frame.raw, frame.len);
+    else if (field == ALARM_TEXT_FIELD) text = alarmTextJson(spec.table, frame.alarmBits);
+    else if (field == "alarm_bits") text = std::to_string(int64_t(frame.alarmBits.lo));
+    else if (field == "alarm_bits_hi" && spec.alarmBytes > 8) text = std::to_string(int64_t(frame.alarmBits.hi));
+    else if (field == "received_time") text = dbFormatRxTime(frame.rx.realNs);
+    else if (field == "rx_time_ns") text = std::to_string(frame.rx.realNs);
+    else if (field == "rx_mono_ns") text = std::to_string(frame.rx.monoNs);
+    else if (field == "device_id") text = spec.deviceId;
+    else return false;
+    return true;
+}
+
+/*
+ * 实时请求直接由内存中的最新帧应答，响应格式与 handleQuery 相同。
+ * 带过滤条件、请求 "*" 或内存中没有的字段时返回 false，由 SQLite 查询应答。
+ * id 取写库线程登记的行号，最新帧尚未提交时为 "NULL"；没有写库线程登记行号时也由 SQLite 应答。
+ */
+static bool realtimeFromLatest(const LatestStore& store, const Json::Value& request, Json::Value& response) {
+    if (request.isMember("filter")) return false;
+    const Json::Value& fields = request["fields"];
+    if (!fields.isArray() || fields.empty()) return false;
+
+    std::string table = request["table"].asString();
+    int id = store.profile().findFrame(table);
+    DecodedFrame frame;
+    if (id < 0 || !store.latest(table, frame)) return false;
+    const FrameSpec& spec = store.profile().frames[id];
+
+    Json::Value row(Json::arrayValue);
+    Json::Value columns(Json::arrayValue);
+    std::string text;
+    for (Json::ArrayIndex i = 0; i < fields.size(); ++i) {
+        if (!fields[i].isString()) return false;
+        if (fields[i].asString() == "id") {
+            int64_t rowId;
+            if (!store.rowId(id, frame.rx.monoNs, rowId)) return false;
+            text = rowId > 0 ? std::to_string(rowId) : "NULL";
+        } else if (!latestFieldText(spec, frame, fields[i].asString(), text)) {
+            return false;
+        }
+        row.append(text);
+        columns.append(fields[i].asString());
+    }
+    response["status"] = "success";
+    response["message"] = "Query processed successfully";
+    response["data"].append(row);
+    response["columns"] = columns;
+    return true;
+}
+
 Json::Value BaseToWeb::handleRealtime(const Json::Value& request) {
+    Json::Value response;
+    if (latest && realtimeFromLatest(*latest, request, response)) return response;
+
     Json::Value modifiedRequest = request;
     modifiedRequest["sort"]["field"] = "received_time";
     modifiedRequest["sort"]["order"] = "DESC";
@@ -29,13 +232,20 @@ Json::Value BaseToWeb::handleRealtime(const Json::Value& request) {
 
 Json::Value BaseToWeb::handleDelete(const Json::Value& request) {
     Json::Value response;
-    if (!db) {
+    if (!openDb()) {
         response["status"] = "error";
         response["message"] = "Database not opened.";
         return response;
     }
 
     std::string table = request["table"].asString();
+    std::string err;
+    TableSchemas schemas;
+    if (!schemas.refresh(db, err) || !schemas.hasTable(table) || !schemas.hasColumn(table, "received_time")) {
+        response["status"] = "error";
+        response["message"] = err.empty() ? "Unknown table: " + table : err;
+        return response;
+    }
     std::string start, end;
     if (request.isMember("filter") && request["filter"].isMember("time_range")) {
         const auto& range = request["filter"]["time_range"];
@@ -43,35 +253,55 @@ Json::Value BaseToWeb::handleDelete(const Json::Value& request) {
         if (range.isMember("end")) end = range["end"].asString();
     }
 
+    // 表名已校验，时间作为绑定值
     std::string whereClause;
+    std::vector<QueryValue> values;
+    auto bindText = [&values](const std::string& text) {
+        QueryValue v;
+        v.isInt = false;
+        v.i = 0;
+        v.text = text;
+        values.push_back(v);
+    };
     if (!start.empty() && !end.empty()) {
-        whereClause = "received_time BETWEEN '" + start + "' AND '" + end + "'";
+        whereClause = "received_time BETWEEN ? AND ?";
+        bindText(start);
+        bindText(end);
     } else if (!start.empty()) {
-        whereClause = "received_time >= '" + start + "'";
+        whereClause = "received_time >= ?";
+        bindText(start);
     } else if (!end.empty()) {
-        whereClause = "received_time <= '" + end + "'";
+        whereClause = "received_time <= ?";
+        bindText(end);
     } else {
         response["status"] = "error";
         response["message"] = "Missing time range";
         return response;
     }
 
-    std::string countSql = "SELECT COUNT(*) FROM " + table + " WHERE " + whereClause;
+    std::vector<std::vector<std::string>> count;
+    std::string sql = "SELECT COUNT(*) FROM \"" + table + "\" WHERE " + whereClause;
+    sqlite3_stmt* stmt = nullptr;
     int rowsBefore = 0;
-    char* errMsg = nullptr;
-    sqlite3_exec(db, countSql.c_str(), [](void* data, int argc, char** argv, char**) {
-        if (argc > 0 && argv[0]) {
-            int* count = static_cast<int*>(data);
-            *count = std::stoi(argv[0]);
-        }
-        return 0;
-    }, &rowsBefore, &errMsg);
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK && bindQuery(stmt, values, err) &&
+        stepRows(stmt, count, err) && !count.empty()) {
+        rowsBefore = std::stoi(count[0][0]);
+    }
+    sqlite3_finalize(stmt);
+
+    sql = "DELETE FROM \"" + table + "\" WHERE " + whereClause;
+    stmt = nullptr;
+    err.clear();
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        err = sqlite3_errmsg(db);
+    } else if (bindQuery(stmt, values, err) && sqlite3_step(stmt) != SQLITE_DONE) {
+        err = sqlite3_errmsg(db);
+    }
+    sqlite3_finalize(stmt);
 
-    std::string sql = "DELETE FROM " + table + " WHERE " + whereClause;
-    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+    if (!err.empty()) {
         response["status"] = "error";
-        response["message"] = errMsg;
-        sqlite3_free(errMsg);
+        response["message"] = err;
     } else {
         response["status"] = "success";
         response["deleted"] = rowsBefore;
@@ -83,31 +313,56 @@ Json::Value BaseToWeb::handleDelete(const Json::Value& request) {
 
 Json::Value BaseToWeb::handleQuery(const Json::Value& request) {
     Json::Value response;
-
-    sqlite3* readDb = nullptr;
-    if (sqlite3_open_v2("/userdata/sqlite/lop1.db", &readDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
-        response["status"] = "error";
-        response["message"] = "Read DB open failed.";
-        return response;
-    }
-
-    std::string sql = generateQuerySql(request);
+    CompiledQuery query;
     std::vector<std::vector<std::string>> results;
-
-    char* errMsg = nullptr;
-    sqlite3_exec(readDb, sql.c_str(), [](void* data, int argc, char** argv, char**) {
-        auto* results = static_cast<std::vector<std::vector<std::string>>*>(data);
-        std::vector<std::string> row;
-        for (int i = 0; i < argc; ++i) {
-            row.emplace_back(argv[i] ? argv[i] : "NULL");
+    std::string err;
+
+    if (pool) {
+        // 从连接池借只读连接，同一形状的查询复用连接上缓存的语句，跳过解析和生成执行计划
+        ReadPool::Lease lease = pool->acquire(QUERY_WAIT_MS, err);
+        if (!lease) {
+            std::cerr << "Read pool: " << err << std::endl;
+            response["status"] = "error";
+            response["message"] = "Read DB open failed.";
+            return response;
         }
-        results->push_back(row);
-        return 0;
-    }, &results, &errMsg);
+        if (lease.schemas().refresh(lease.db(), err) && compileQuery(request, lease.schemas(), query, err)) {
+            sqlite3_stmt* stmt = lease.prepare(query.sql, err);
+            if (stmt && bindQuery(stmt, query.values, err)) stepRows(stmt, results, err);
+        }
+    } else {
+        sqlite3* readDb = nullptr;
+        if (sqlite3_open_v2(dbPath.c_str(), &readDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+            sqlite3_close(readDb);
+            response["status"] = "error";
+            response["message"] = "Read DB open failed.";
+            return response;
+        }
+        registerAlarmFunctions(readDb);
+        TableSchemas schemas;
+        sqlite3_stmt* stmt = nullptr;
+        if (schemas.refresh(readDb, err) && compileQuery(request, schemas, query, err)) {
+            if (sqlite3_prepare_v2(readDb, query.sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+                err = sqlite3_errmsg(readDb);
+            } else if (bindQuery(stmt, query.values, err)) {
+                stepRows(stmt, results, err);
+            }
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_close(readDb);
+    }
 
-    sqlite3_close(readDb);
+    // 游标翻页：用最后一行的附加列生成下一页游标，再从每行去掉
+    std::string nextCursor;
+    if (err.empty() && query.hiddenColumns && !results.empty()) {
+        const std::vector<std::string>& last = results.back();
+        size_t n = last.size() - query.hiddenColumns;
+        // received_time 为空的行排在最后，之后没有可定位的下一页
+        if (int(results.size()) == query.limit && last[n] != "NULL") nextCursor = encodeCursor(last[n], last[n + 1]);
+        for (std::vector<std::string>& row : results) row.resize(n);
+    }
 
-    if (!errMsg && !results.empty()) {
+    if (err.empty() && !results.empty()) {
         response["status"] = "success";
         response["message"] = "Query processed successfully";
         Json::Value data;
@@ -128,111 +383,172 @@ Json::Value BaseToWeb::handleQuery(const Json::Value& request) {
             }
             response["columns"] = columns;
         }
+        if (!nextCursor.empty()) response["next_cursor"] = nextCursor;
     } else {
         response["status"] = "error";
-        response["message"] = errMsg ? errMsg : "No results found.";
-        if (errMsg) sqlite3_free(errMsg);
+        response["message"] = !err.empty() ? err : "No results found.";
     }
 
     return response;
 }
 
-std::vector<std::vector<std::string>> BaseToWeb::executeQuery(const std::string& sql) {
-    std::vector<std::vector<std::string>> results;
-    char* errMsg = nullptr;
-
-    if (sqlite3_exec(db, sql.c_str(), [](void* data, int argc, char** argv, char**) {
-        std::vector<std::vector<std::string>>* results = static_cast<std::vector<std::vector<std::string>>*>(data);
-        std::vector<std::string> row;
-        for (int i = 0; i < argc; ++i) {
-            row.emplace_back(argv[i] ? argv[i] : "NULL");
-        }
-        results->push_back(row);
-        return 0;
-    }, &results, &errMsg) != SQLITE_OK) {
-        std::cerr << "SQL error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-    }
+const int QueryStream::SNAPSHOT_LIMIT_S;
 
-    return results;
+QueryStream::QueryStream(ReadPool::Lease&& lease, sqlite3_stmt* stmt, const std::string& head,
+                         size_t hiddenColumns, int limit, const Json::Value& sliced)
+    : lease_(std::move(lease)), stmt_(stmt), head_(head),
+      columns_(size_t(sqlite3_column_count(stmt)) - hiddenColumns), hiddenColumns_(hiddenColumns), limit_(limit),
+      sliced_(sliced), opened_(std::chrono::steady_clock::now()) {
 }
 
-std::string BaseToWeb::generateQuerySql(const Json::Value& request) {
-    std::string table_name = request["table"].asString();
-    const Json::Value& fields = request["fields"];
-    std::string sql;
-
-    if (!fields.isArray() || fields.empty()) {
-        return "ERROR: Fields array missing or invalid.";
+// 从上一段最后一行之后重新查询，剩余行数按原请求的 limit 计算(-1 为不限)
+void QueryStream::reseek() {
+    paused_ = false;
+    Json::Value& pagination = sliced_["pagination"];
+    pagination["cursor"] = encodeCursor(lastTime_, lastId_);
+    if (limit_ >= 0) pagination["limit"] = int(limit_ - int64_t(rows_));
+
+    CompiledQuery query;
+    std::string err;
+    int rc = SQLITE_DONE;
+    if (lease_.schemas().refresh(lease_.db(), err) && compileQuery(sliced_, lease_.schemas(), query, err)) {
+        stmt_ = lease_.prepare(query.sql, err);
+        if (stmt_ && size_t(sqlite3_column_count(stmt_)) != columns_ + hiddenColumns_) err = "Table changed during export";
+        else if (stmt_ && bindQuery(stmt_, query.values, err)) rc = sqlite3_step(stmt_);
+        if (rc != SQLITE_ROW && rc != SQLITE_DONE) err = sqlite3_errmsg(lease_.db());
     }
+    if (err.empty() && rc == SQLITE_ROW) return;
+    hasRow_ = false;
+    error_ = err;
+}
 
-    bool useAllFields = (fields.size() == 1 && fields[0].asString() == "*");
-
-    if (useAllFields) {
-        sql = "SELECT * FROM " + table_name;
-    } else {
-        sql = "SELECT ";
-        for (Json::ArrayIndex i = 0; i < fields.size(); ++i) {
-            if (!fields[i].isString()) {
-                return "ERROR: Field name must be string.";
-            }
-            sql += fields[i].asString();
-            if (i != fields.size() - 1) sql += ", ";
+bool QueryStream::next(std::string& out, size_t size) {
+    if (done_) return false;
+    if (paused_ && hasRow_) reseek();
+    // 不能分段读取时读事务一直不结束，限制总时长
+    if (hasRow_ && sliced_.isNull() &&
+        std::chrono::steady_clock::now() - opened_ > std::chrono::seconds(SNAPSHOT_LIMIT_S)) {
+        cancel("Export took longer than " + std::to_string(SNAPSHOT_LIMIT_S) + " s; sort by received_time to export in slices");
+    }
+    size_t start = out.size();
+    out += head_;
+    head_.clear();
+    while (hasRow_ && out.size() - start < size) {
+        out += rows_ ? ",[" : "[";
+        for (size_t i = 0; i < columns_; ++i) {
+            if (i) out += ',';
+            out += Json::valueToQuotedString(columnText(stmt_, int(i)).c_str());
+        }
+        out += ']';
+        ++rows_;
+        if (hiddenColumns_) {
+            lastTime_ = columnText(stmt_, int(columns_));
+            lastId_ = columnText(stmt_, int(columns_) + 1);
+        }
+        int rc = sqlite3_step(stmt_);
+        if (rc != SQLITE_ROW) {
+            hasRow_ = false;
+            if (rc != SQLITE_DONE) error_ = sqlite3_errmsg(sqlite3_db_handle(stmt_));
         }
-        sql += " FROM " + table_name;
     }
+    if (!hasRow_) {
+        finish(out);
+    } else if (!sliced_.isNull() && lastTime_ != "NULL") {
+        // received_time 为空的行无法定位，停在这些行上时不分段
+        sqlite3_reset(stmt_);
+        paused_ = true;
+    }
+    return true;
+}
 
-    std::vector<std::string> where_clauses;
-
-    if (request.isMember("filter") && request["filter"].isObject()) {
-        const Json::Value& filter = request["filter"];
-
-        if (filter.isMember("time_range") && filter["time_range"].isObject()) {
-            const Json::Value& timeRange = filter["time_range"];
-            std::string start, end;
-
-            if (timeRange.isMember("start")) start = timeRange["start"].asString();
-            if (timeRange.isMember("end")) end = timeRange["end"].asString();
+void QueryStream::cancel(const std::string& reason) {
+    if (done_ || !hasRow_) return;
+    hasRow_ = false;
+    error_ = reason;
+}
 
-            if (!start.empty() && !end.empty()) {
-                where_clauses.push_back("received_time BETWEEN '" + start + "' AND '" + end + "'");
-            } else if (!start.empty()) {
-                where_clauses.push_back("received_time >= '" + start + "'");
-            } else if (!end.empty()) {
-                where_clauses.push_back("received_time <= '" + end + "'");
-            }
+// 写出 data 之后的字段(与 jsoncpp 一样按键名排序)，归还连接
+void QueryStream::finish(std::string& out) {
+    out += ']';
+    if (error_.empty()) {
+        out += ",\"message\":\"Query processed successfully\"";
+        // 与 handleQuery 相同：取满一页且 received_time 不为空时才有下一页
+        if (hiddenColumns_ && int64_t(rows_) == limit_ && lastTime_ != "NULL") {
+            out += ",\"next_cursor\":" + Json::valueToQuotedString(encodeCursor(lastTime_, lastId_).c_str());
         }
+        out += ",\"status\":\"success\"}";
+    } else {
+        std::cerr << "Query stream: " << error_ << std::endl;
+        out += ",\"message\":" + Json::valueToQuotedString(error_.c_str()) + ",\"status\":\"error\"}";
+    }
+    done_ = true;
+    lease_ = ReadPool::Lease();
+}
 
-        if (filter.isMember("conditions") && filter["conditions"].isArray()) {
-            for (const auto& cond : filter["conditions"]) {
-                std::string field = cond["field"].asString();
-                std::string op = cond["op"].asString();
-                std::string val = cond["value"].asString();
-                where_clauses.push_back(field + " " + op + " '" + val + "'");
+std::unique_ptr<QueryStream> BaseToWeb::streamQuery(const Json::Value& request, Json::Value& response) {
+    CompiledQuery query;
+    std::string err;
+    sqlite3_stmt* stmt = nullptr;
+    int rc = SQLITE_DONE;
+
+    // 导出连接都在使用时立即拒绝，不占住 io 线程等待
+    ReadPool::Lease lease;
+    if (!pool) err = "Read pool unavailable";
+    else lease = pool->acquire(0, err);
+    // 按 received_time 排序、不带 offset 的请求改为游标翻页形式，便于分段重新定位
+    Json::Value sliced;
+    if (lease && lease.schemas().refresh(lease.db(), err)) {
+        const Json::Value& sort = request["sort"];
+        const Json::Value& pagination = request["pagination"];
+        std::string table = request["table"].asString();
+        const TableSchemas& schemas = lease.schemas();
+        if (sort.isObject() && sort["field"].asString() == "received_time" && schemas.hasColumn(table, "received_time")
+            && schemas.hasColumn(table, "id") && (!pagination.isObject() || pagination.isMember("cursor"))) {
+            sliced = request;
+            if (!pagination.isObject()) {
+                sliced["pagination"]["cursor"] = "";
+                sliced["pagination"]["limit"] = -1;
             }
         }
     }
-
-    if (!where_clauses.empty()) {
-        sql += " WHERE ";
-        for (size_t i = 0; i < where_clauses.size(); ++i) {
-            sql += where_clauses[i];
-            if (i != where_clauses.size() - 1) sql += " AND ";
+    // 先按原请求编译，出错信息与 handleQuery 相同
+    if (lease && err.empty() && compileQuery(request, lease.schemas(), query, err) &&
+        (sliced.isNull() || compileQuery(sliced, lease.schemas(), query, err))) {
+        stmt = lease.prepare(query.sql, err);
+        // 先取第一行，没有结果或出错时仍按普通应答返回
+        if (stmt && bindQuery(stmt, query.values, err)) {
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_ROW && rc != SQLITE_DONE) err = sqlite3_errmsg(lease.db());
         }
     }
+    if (!err.empty() || rc != SQLITE_ROW) {
+        response["status"] = "error";
+        response["message"] = !err.empty() ? err : "No results found.";
+        return std::unique_ptr<QueryStream>();
+    }
 
-    if (request.isMember("sort") && request["sort"].isObject()) {
-        std::string column = request["sort"]["field"].asString();
-        std::string order = request["sort"]["order"].asString();
-        sql += " ORDER BY " + column + " " + order;
+    std::string head = "{";
+    if (request.isMember("fields") && request["fields"].isArray()) {
+        const Json::Value& fields = request["fields"];
+        head += "\"columns\":[";
+        for (Json::ArrayIndex i = 0; i < fields.size(); ++i) {
+            if (i) head += ',';
+            head += Json::valueToQuotedString(fields[i].asString().c_str());
+        }
+        head += "],";
     }
+    head += "\"data\":[";
+    return std::unique_ptr<QueryStream>(new QueryStream(std::move(lease), stmt, head, query.hiddenColumns, query.limit,
+                                                        sliced));
+}
+
+std::vector<std::vector<std::string>> BaseToWeb::executeQuery(const std::string& sql) {
+    std::vector<std::vector<std::string>> results;
+    std::string err;
 
-    if (request.isMember("pagination") && request["pagination"].isObject()) {
-        int offset = request["pagination"].get("offset", 0).asInt();
-        int limit = request["pagination"].get("limit", 100).asInt();
-        sql += " LIMIT " + std::to_string(limit) + " OFFSET " + std::to_string(offset);
+    if (!openDb() || !readRows(db, sql, results, err)) {
+        std::cerr << "SQL error: " << err << std::endl;
     }
 
-    sql += ";";
-    return sql;
+    return results;
 }
@@ -2,24 +2,89 @@
 #define BASETOWEB_H
 
 #include <json/json.h>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
+#include "read_pool.h"
 
 class sqlite3;
+class LatestStore;
+struct FrameSpec;
+struct DecodedFrame;
+
+// 内存最新帧中一个字段的文本值，格式与 SQLite 查询结果相同；不能从内存取的字段(如 id)返回 false
+bool latestFieldText(const FrameSpec& spec, const DecodedFrame& frame, const std::string& field, std::string& text);
+
+// 注册查询用到的 SQL 函数 alarm_text、alarm_name，每个查询连接打开后调用一次
+void registerAlarmFunctions(sqlite3* db);
+
+/*
+ * 流式历史查询的应答正文：语句停在下一行上，每次 next() 读出若干行直接写成 JSON 文本，
+ * 内存中只有当前一段，与结果行数无关。正文与 handleQuery 的应答等价(status、message 在 data 之后)，
+ * 中途出错时以 status 为 error 的结尾收尾。持有借出的只读连接，正文取完后立即归还。
+ *
+ * 按 received_time 排序的请求按 (received_time, id) 游标分段读取：每段写完后重置语句、结束读事务，
+ * 下一段从上一段最后一行之后重新定位，慢客户端不会让读事务一直挡住 WAL 检查点；
+ * 各段看到的是各自开始时的数据。其它排序只能用一条语句读完，最多读 SNAPSHOT_LIMIT_S 秒。
+ */
+class QueryStream {
+public:
+    static const int SNAPSHOT_LIMIT_S = 60;
+
+
+    // 把下一段正文追加到 out，约 size 字节(不拆行)；正文已全部取出时返回 false
+    bool next(std::string& out, size_t size);
+    // 不再读取剩余行，下一段以 reason 为错误信息结束正文
+    void cancel(const std::string& reason);
+
+private:
+    friend class BaseToWeb;
+    QueryStream(ReadPool::Lease&& lease, sqlite3_stmt* stmt, const std::string& head, size_t hiddenColumns, int limit,
+                const Json::Value& sliced);
+
+    ReadPool::Lease lease_;
+    sqlite3_stmt* stmt_;
+    std::string head_;          // 尚未取出的开头 {"columns":[...],"data":[
+    size_t columns_;            // 输出的列数，不含游标附加列
+    size_t hiddenColumns_;
+    int limit_;
+    uint64_t rows_ = 0;
+    bool hasRow_ = true;        // 语句停在一行上，尚未输出
+    bool done_ = false;
+    std::string lastTime_;      // 最后一行的游标附加列
+    std::string lastId_;
+    std::string error_;
+    Json::Value sliced_;        // 可分段读取时为游标翻页形式的请求，否则为 null
+    bool paused_ = false;       // 语句已重置，下一段需重新定位
+    std::chrono::steady_clock::time_point opened_;
+
+    void reseek();
+    void finish(std::string& out);
+};
 
 class BaseToWeb {
 public:
-    BaseToWeb(const std::string& dbPath);
+    // latest 非空时实时接口优先从内存中的最新帧取值(与采集同进程时)；
+    // pool 非空时查询从连接池借只读连接，否则每次查询单独打开
+    BaseToWeb(const std::string& dbPath, const LatestStore* latest = nullptr, ReadPool* pool = nullptr);
     ~BaseToWeb();
 
     Json::Value handleQuery(const Json::Value& request);
     Json::Value handleRealtime(const Json::Value& request);
     Json::Value handleDelete(const Json::Value& request);
 
+    // 与 handleQuery 相同的请求，结果由返回的 QueryStream 逐段生成；需要连接池，不等待空闲连接。
+    // 出错或没有结果时返回空，response 为与 handleQuery 相同的错误应答
+    std::unique_ptr<QueryStream> streamQuery(const Json::Value& request, Json::Value& response);
+
 private:
     sqlite3* db;
+    std::string dbPath;
+    const LatestStore* latest;
+    ReadPool* pool;
+    bool openDb();
     std::vector<std::vector<std::string>> executeQuery(const std::string& sql);
-    std::string generateQuerySql(const Json::Value& request);
 };
 
 #endif // BASETOWEB_H
\ No newline at end of file
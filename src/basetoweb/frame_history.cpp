@@ -0,0 +1,33 @@
+// frame_history.cpp
+#include "frame_history.h"
+
+FrameHistory::FrameHistory(size_t capacity)
+    : ring_(capacity ? capacity : 1) {
+}
+
+uint64_t FrameHistory::push(const DecodedFrame& frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t seq = next_++;
+    Entry& entry = ring_[seq % ring_.size()];
+    entry.seq = seq;
+    entry.frame = frame;
+    return seq;
+}
+
+uint64_t FrameHistory::lastSeq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_ - 1;
+}
+
+size_t FrameHistory::since(uint64_t after, std::vector<Entry>& out, size_t max, bool* gap) const {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t oldest = next_ > ring_.size() ? next_ - ring_.size() : 1;
+    uint64_t first = after + 1;
+    if (gap) *gap = first < oldest;
+    if (first < oldest) first = oldest;
+    for (uint64_t seq = first; seq < next_ && out.size() < max; ++seq) {
+        out.push_back(ring_[seq % ring_.size()]);
+    }
+    return out.size();
+}
@@ -0,0 +1,37 @@
+// frame_history.h
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+#include "decode_program.h"
+
+/*
+ * 最近解码的若干帧(不分帧种类，按到达顺序)，每帧一个从 1 开始的全局序号。
+ * 流式接口用序号作为事件 id，断线重连时从这里补发错过的帧；超出容量的旧帧被覆盖。
+ * 写入和读取都持有内部锁，读取时按值拷贝。
+ */
+class FrameHistory {
+public:
+    struct Entry {
+        uint64_t seq;
+        DecodedFrame frame;
+    };
+
+    explicit FrameHistory(size_t capacity);
+
+    // 追加一帧，返回它的序号
+    uint64_t push(const DecodedFrame& frame);
+
+    // 最新一帧的序号，0 表示还没有帧
+    uint64_t lastSeq() const;
+
+    // 按顺序取序号大于 after 的帧，最多 max 个，返回取到的个数；
+    // after 之后的帧已有被覆盖的时返回 true 到 *gap，从仍保留的最旧一帧开始取
+    size_t since(uint64_t after, std::vector<Entry>& out, size_t max, bool* gap = nullptr) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Entry> ring_;
+    uint64_t next_ = 1;
+};
@@ -0,0 +1,20 @@
+// frame_json.h
+#pragma once
+
+#include <json/json.h>
+#include "frame_fields.h"
+
+/*
+ * 由帧字段描述表生成 JSON 对象，字段名与数据库列名一致，
+ * 实时数据与历史查询返回的字段名相同。
+ */
+template <typename Data, size_t N>
+Json::Value frameToJson(const FieldDesc<Data> (&fields)[N], const Data& data)
+{
+    Json::Value obj(Json::objectValue);
+    for (size_t i = 0; i < N; ++i) {
+        if (fields[i].isInteger()) obj[fields[i].column] = Json::UInt(data.*(fields[i].u16));
+        else                       obj[fields[i].column] = double(data.*(fields[i].f32));
+    }
+    return obj;
+}
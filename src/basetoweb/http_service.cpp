@@ -0,0 +1,1222 @@
+// http_service.cpp
+#include "http_service.h"
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/asio.hpp>
+#include <boost/optional.hpp>
+#include <json/json.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "basetoweb.h"
+#include "read_pool.h"
+#include "realtime_hub.h"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+const int HttpService::IDLE_TIMEOUT_S;
+const int HttpService::PIPELINE_LIMIT;
+const int HttpService::SHUTDOWN_GRACE_S;
+const int HttpService::EXPORT_STREAMS;
+
+typedef http::request<http::string_body> Request;
+typedef http::response<http::string_body> Response;
+
+// 请求体上限，查询和删除请求都很小
+static const size_t BODY_LIMIT = 1024 * 1024;
+// 推送通道客户端消息上限(订阅命令)
+static const size_t WS_MESSAGE_LIMIT = 4 * 1024;
+// 推送通道待写消息达到此数时暂停读取客户端命令，写出后再恢复；只发命令不收消息的客户端不会让队列无限增长
+static const size_t WS_OUT_LIMIT = 8;
+// 应答中回显客户端字符串(动作、表名、字段名)的最大字节数
+static const size_t WS_ECHO_LIMIT = 64;
+// 推送连接(WebSocket 和 SSE)的内核发送缓冲，调小后慢客户端很快反压到合并推送，而不是在内核里积压几秒的旧值
+static const int PUSH_SEND_BUFFER = 16 * 1024;
+// 同一推送连接两次推送的最小间隔，间隔内到达的帧合并成一条
+static const int WS_PUSH_INTERVAL_MS = 20;
+// SSE 连接一次写出的最多事件数
+static const size_t SSE_BATCH = 64;
+// SSE 连接空闲多久发一次心跳注释，防止代理因无数据断开
+static const int SSE_HEARTBEAT_S = 15;
+// SSE 合并推送间隔上限
+static const int SSE_MAX_INTERVAL_MS = 60000;
+// 流式导出每次生成并写出的正文大小
+static const size_t EXPORT_CHUNK = 64 * 1024;
+
+// ★ 所有响应(包括出错和 OPTIONS 预检)都必须带 CORS 头
+template <class Message>
+static void setCors(Message& res) {
+    res.set(http::field::access_control_allow_origin, "*");
+    res.set(http::field::access_control_allow_methods, "POST, GET, OPTIONS");
+    res.set(http::field::access_control_allow_headers, "Content-Type, Last-Event-ID");
+}
+
+// 完整应答，版本和 keep-alive 跟随请求
+static std::shared_ptr<Response> textResponse(const Request& req, http::status status, const std::string& body,
+                                              const char* contentType = "text/plain") {
+    std::shared_ptr<Response> res = std::make_shared<Response>(status, req.version());
+    res->keep_alive(req.keep_alive());
+    setCors(*res);
+    res->set(http::field::content_type, contentType);
+    res->body() = body;
+    res->prepare_payload();
+    return res;
+}
+
+static bool parseJsonBody(const Request& req, Json::Value& json) {
+    Json::CharReaderBuilder builder;
+    std::string errs;
+    std::istringstream s(req.body());
+    return Json::parseFromStream(builder, s, &json, &errs);
+}
+
+static const char INVALID_JSON[] = "{\"status\":\"error\",\"message\":\"Invalid JSON\"}";
+
+// 按请求生成完整应答，版本和 keep-alive 跟随请求
+static std::shared_ptr<Response> handleRequest(const Request& req, const std::string& dbPath, const LatestStore* latest,
+                                               ReadPool* pool) {
+    // CORS预检，所有OPTIONS直接返回200
+    if (req.method() == http::verb::options) {
+        return textResponse(req, http::status::ok, "OK");
+    }
+
+    Json::Value request_json;
+    if (!parseJsonBody(req, request_json)) {
+        return textResponse(req, http::status::bad_request, INVALID_JSON, "application/json");
+    }
+
+    BaseToWeb db(dbPath, latest, pool);
+    Json::Value response_json;
+    if (req.method() == http::verb::post && req.target() == "/api/data/realtime") {
+        response_json = db.handleRealtime(request_json);
+    } else if (req.method() == http::verb::post && req.target() == "/api/data/query") {
+        response_json = db.handleQuery(request_json);
+    } else if (req.method() == http::verb::post && req.target() == "/api/data/delete") {
+        response_json = db.handleDelete(request_json);
+    } else {
+        return textResponse(req, http::status::not_found, "Unknown endpoint");
+    }
+
+    Json::StreamWriterBuilder writer;
+    return textResponse(req, http::status::ok, Json::writeString(writer, response_json), "application/json");
+}
+
+// 流式应答：先写头部，正文由 QueryStream 逐段生成写出；HTTP/1.1 用 chunked 编码，HTTP/1.0 写完关闭连接
+struct StreamReply {
+    http::response<http::empty_body> head;
+    std::unique_ptr<http::response_serializer<http::empty_body>> serializer;
+    std::unique_ptr<QueryStream> body;
+    std::string size;           // chunk 头
+    std::string text;           // 正在写出的一段正文
+    bool finished = false;      // 已写结束块
+};
+
+// 排队等待写出的应答，res 和 stream 二者之一非空
+struct Reply {
+    std::shared_ptr<Response> res;
+    std::shared_ptr<StreamReply> stream;
+
+    bool keepAlive() const { return res ? res->keep_alive() : stream->head.keep_alive(); }
+    void close() {
+        if (res) res->keep_alive(false);
+        else stream->head.keep_alive(false);
+    }
+};
+
+// POST /api/data/export：请求和应答与 /api/data/query 相同，有结果时应答正文边查边写
+static Reply handleExport(const Request& req, const std::string& dbPath, ReadPool* pool) {
+    Reply reply;
+    Json::Value request_json;
+    if (!parseJsonBody(req, request_json)) {
+        reply.res = textResponse(req, http::status::bad_request, INVALID_JSON, "application/json");
+        return reply;
+    }
+
+    BaseToWeb db(dbPath, nullptr, pool);
+    Json::Value response_json;
+    std::unique_ptr<QueryStream> body = db.streamQuery(request_json, response_json);
+    if (!body) {
+        Json::StreamWriterBuilder writer;
+        reply.res = textResponse(req, http::status::ok, Json::writeString(writer, response_json), "application/json");
+        return reply;
+    }
+
+    reply.stream = std::make_shared<StreamReply>();
+    http::response<http::empty_body>& head = reply.stream->head;
+    head.version(req.version());
+    head.result(http::status::ok);
+    setCors(head);
+    head.set(http::field::content_type, "application/json");
+    if (req.version() >= 11) {
+        head.keep_alive(req.keep_alive());
+        head.chunked(true);
+    } else {
+        head.keep_alive(false);
+    }
+    reply.stream->body = std::move(body);
+    return reply;
+}
+
+// HTTP 连接和推送连接的公共接口，服务退出时逐个通知
+class Session {
+public:
+    virtual ~Session() {}
+    // 可在任意线程调用
+    virtual void shutdown() = 0;
+};
+
+// 各连接共享的服务状态，生命周期与 HttpService 相同
+struct ServiceContext {
+    std::string dbPath;
+    const LatestStore* latest;
+    RealtimeHub* hub;
+    ReadPool* pool;
+    ReadPool* exportPool;       // 流式导出专用，慢客户端占住连接时不影响普通查询
+
+    std::mutex mutex;
+    std::vector<std::weak_ptr<Session>> sessions;
+    bool stopping = false;
+
+    // 登记新连接，顺带清理已结束的；服务已在退出时立即通知该连接关闭
+    void add(const std::shared_ptr<Session>& session) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                          [](const std::weak_ptr<Session>& s) { return s.expired(); }),
+                           sessions.end());
+            sessions.push_back(session);
+            if (!stopping) return;
+        }
+        session->shutdown();
+    }
+
+    void shutdownAll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (const std::weak_ptr<Session>& weak : sessions) {
+            if (std::shared_ptr<Session> session = weak.lock()) session->shutdown();
+        }
+    }
+
+    bool live() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::weak_ptr<Session>& weak : sessions) {
+            if (!weak.expired()) return true;
+        }
+        return false;
+    }
+};
+
+// 采集线程与推送连接共享的唤醒标志
+struct Wake {
+    std::atomic<bool> dirty;
+    std::atomic<uint64_t> mask;     // 订阅的帧(下标 0~63 各占一位，更大的下标总是唤醒)
+    Wake() : dirty(false), mask(0) {}
+
+    void clear() { mask.store(0, std::memory_order_relaxed); }
+    void add(int frame) {
+        if (frame < 64) mask.fetch_or(uint64_t(1) << frame, std::memory_order_relaxed);
+    }
+    bool wants(int frame) const {
+        return frame >= 64 || (mask.load(std::memory_order_relaxed) & (uint64_t(1) << frame));
+    }
+};
+
+/*
+ * 在 hub 上登记连接：订阅的帧有更新时置 dirty，
+ * 从 false 变 true 时才向连接的 strand 投递一次 onWake()，之后的帧由这次 onWake 合并处理。
+ * 回调只持有连接的弱引用，连接析构时注销。
+ */
+template <class SessionType, class Executor>
+static int subscribeWake(RealtimeHub& hub, const std::shared_ptr<SessionType>& session,
+                         const std::shared_ptr<Wake>& wake, Executor executor) {
+    std::weak_ptr<SessionType> weak = session;
+    return hub.subscribe([weak, wake, executor](int frame) {
+        if (!wake->wants(frame) || wake->dirty.exchange(true)) return;
+        net::post(executor, [weak]() {
+            if (std::shared_ptr<SessionType> self = weak.lock()) self->onWake();
+        });
+    });
+}
+
+/*
+ * 推送连接(/ws/realtime)：客户端发送
+ *   {"action": "subscribe", "table": "lop1_frame1", "fields": ["rpm1", "oil_pressure"]}
+ *   {"action": "unsubscribe", "table": "lop1_frame1"}
+ * fields 省略时订阅该帧全部字段和 received_time。每条命令先回一条 {"status": ..., "message": ...}，
+ * 订阅成功后推送一次全部字段，之后每有新帧只推送值有变化的字段：
+ *   {"table": "lop1_frame1", "version": 123, "values": {"rpm1": "1500"}}
+ * 字段值为文本，格式与 /api/data/realtime 相同。
+ *
+ * 采集线程只置一个标志并投递一次发送；上一条消息没写完或距上次推送不到 WS_PUSH_INTERVAL_MS 时
+ * 不生成新消息，之后按内存中的最新帧合并推送，慢客户端只会少收中间帧，不会积压。
+ * 命令应答在待写消息达到 WS_OUT_LIMIT 条时暂停读取，同样不会积压。
+ */
+class WsSession : public Session, public std::enable_shared_from_this<WsSession> {
+public:
+    WsSession(beast::tcp_stream&& stream, ServiceContext& ctx)
+        : ws_(std::move(stream)), hub_(*ctx.hub), wake_(std::make_shared<Wake>()), timer_(ws_.get_executor()) {
+        writer_["indentation"] = "";
+    }
+
+    ~WsSession() {
+        if (subscription_) hub_.unsubscribe(subscription_);
+    }
+
+    // 在原 HTTP 连接的 strand 上调用
+    void run(const Request& req) {
+        beast::get_lowest_layer(ws_).expires_never();
+        beast::error_code ec;
+        beast::get_lowest_layer(ws_).socket().set_option(net::socket_base::send_buffer_size(PUSH_SEND_BUFFER), ec);
+        websocket::stream_base::timeout timeout = websocket::stream_base::timeout::suggested(beast::role_type::server);
+        timeout.keep_alive_pings = true;
+        ws_.set_option(timeout);
+        ws_.read_message_max(WS_MESSAGE_LIMIT);
+        ws_.async_accept(req, beast::bind_front_handler(&WsSession::onAccept, shared_from_this()));
+    }
+
+    void shutdown() override {
+        net::post(ws_.get_executor(), beast::bind_front_handler(&WsSession::onShutdown, shared_from_this()));
+    }
+
+    // 有订阅的帧更新后在本连接的 strand 上执行
+    void onWake() {
+        flush();
+    }
+
+private:
+    struct Subscription {
+        int frame;
+        std::vector<std::string> fields;
+        std::vector<std::string> last;  // 上次推送的值
+        bool snapshot;                  // 下次推送全部字段
+        uint32_t version;
+    };
+
+    websocket::stream<beast::tcp_stream> ws_;
+    RealtimeHub& hub_;
+    std::shared_ptr<Wake> wake_;
+    int subscription_ = 0;
+    beast::flat_buffer buffer_;
+    std::vector<Subscription> subs_;
+    std::deque<std::string> out_;
+    Json::StreamWriterBuilder writer_;
+    net::steady_timer timer_;
+    std::chrono::steady_clock::time_point lastPush_;
+    bool writing_ = false;
+    bool reading_ = false;
+    bool flushPending_ = false;     // 写完后再按最新帧推送一次
+    bool timerArmed_ = false;
+    bool closing_ = false;
+    bool closed_ = false;
+
+    void onAccept(beast::error_code ec) {
+        if (ec) {
+            std::cerr << "WebSocket accept error: " << ec.message() << std::endl;
+            return;
+        }
+        subscription_ = subscribeWake(hub_, shared_from_this(), wake_, ws_.get_executor());
+        if (closing_) {
+            doClose();
+            return;
+        }
+        doRead();
+    }
+
+    void doRead() {
+        reading_ = true;
+        ws_.async_read(buffer_, beast::bind_front_handler(&WsSession::onRead, shared_from_this()));
+    }
+
+    void onRead(beast::error_code ec, std::size_t) {
+        reading_ = false;
+        if (ec) {
+            if (ec != websocket::error::closed && ec != net::error::operation_aborted) {
+                std::cerr << "WebSocket error: " << ec.message() << std::endl;
+            }
+            return;
+        }
+        std::string text = beast::buffers_to_string(buffer_.data());
+        buffer_.consume(buffer_.size());
+        handleCommand(text);
+        // 应答积压时暂停读取，由 onWrite 恢复
+        if (out_.size() < WS_OUT_LIMIT) doRead();
+    }
+
+    // 回显的客户端字符串截短，截断处不拆开 UTF-8 字符
+    static std::string echo(const Json::Value& value) {
+        std::string text = value.isString() ? value.asString() : "";
+        if (text.size() <= WS_ECHO_LIMIT) return text;
+        size_t n = WS_ECHO_LIMIT;
+        while (n > 0 && (static_cast<unsigned char>(text[n]) & 0xC0) == 0x80) --n;
+        return text.substr(0, n) + "...";
+    }
+
+    void reply(const std::string& status, const std::string& message) {
+        Json::Value msg;
+        msg["status"] = status;
+        msg["message"] = message;
+        send(Json::writeString(writer_, msg));
+    }
+
+    void handleCommand(const std::string& text) {
+        Json::Value cmd;
+        Json::CharReaderBuilder builder;
+        std::string errs;
+        std::istringstream s(text);
+        if (!Json::parseFromStream(builder, s, &cmd, &errs) || !cmd.isObject()) {
+            reply("error", "Invalid JSON");
+            return;
+        }
+        const LatestStore& store = hub_.store();
+        std::string action = cmd["action"].isString() ? cmd["action"].asString() : "";
+        std::string table = cmd["table"].isString() ? cmd["table"].asString() : "";
+        int frame = store.profile().findFrame(table);
+        if (action != "subscribe" && action != "unsubscribe") {
+            reply("error", "Unknown action: " + echo(cmd["action"]));
+            return;
+        }
+        if (frame < 0) {
+            reply("error", "Unknown table: " + echo(cmd["table"]));
+            return;
+        }
+
+        const FrameSpec& spec = store.profile().frames[frame];
+        Subscription sub;
+        sub.frame = frame;
+        sub.snapshot = true;
+        sub.version = 0;
+        if (action == "subscribe") {
+            const Json::Value& fields = cmd["fields"];
+            if (fields.isArray() && !fields.empty()) {
+                // 用一帧空数据校验字段名
+                DecodedFrame probe;
+                std::memset(&probe, 0, sizeof(probe));
+                std::string value;
+                for (Json::ArrayIndex i = 0; i < fields.size(); ++i) {
+                    if (!fields[i].isString() || !latestFieldText(spec, probe, fields[i].asString(), value)) {
+                        reply("error", "Unknown field: " + echo(fields[i]));
+                        return;
+                    }
+                    sub.fields.push_back(fields[i].asString());
+                }
+            } else {
+                for (const FieldSpec& field : spec.fields) sub.fields.push_back(field.column);
+                sub.fields.push_back("received_time");
+            }
+            sub.last.resize(sub.fields.size());
+        }
+
+        // 同一张表重复订阅时替换原订阅
+        for (size_t i = 0; i < subs_.size(); ++i) {
+            if (subs_[i].frame == frame) {
+                subs_.erase(subs_.begin() + i);
+                break;
+            }
+        }
+        if (action == "subscribe") subs_.push_back(sub);
+
+        wake_->clear();
+        for (const Subscription& s : subs_) wake_->add(s.frame);
+
+        reply("success", (action == "subscribe" ? "Subscribed " : "Unsubscribed ") + table);
+        flush();
+    }
+
+    // 把各订阅自上次推送以来的变化写出；正在写时推迟到写完，离上次推送太近时推迟到间隔结束
+    void flush() {
+        wake_->dirty.store(false);
+        if (closing_) return;
+        if (writing_) {
+            flushPending_ = true;
+            return;
+        }
+        flushPending_ = false;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point next = lastPush_ + std::chrono::milliseconds(WS_PUSH_INTERVAL_MS);
+        if (now < next) {
+            if (!timerArmed_) {
+                timerArmed_ = true;
+                timer_.expires_at(next);
+                timer_.async_wait(beast::bind_front_handler(&WsSession::onTimer, shared_from_this()));
+            }
+            return;
+        }
+
+        const LatestStore& store = hub_.store();
+        DecodedFrame frame;
+        std::string text;
+        for (Subscription& sub : subs_) {
+            uint32_t version = store.version(sub.frame);
+            if (version == sub.version || !store.latest(sub.frame, frame)) continue;
+            const FrameSpec& spec = store.profile().frames[sub.frame];
+            Json::Value values(Json::objectValue);
+            for (size_t i = 0; i < sub.fields.size(); ++i) {
+                latestFieldText(spec, frame, sub.fields[i], text);
+                if (sub.snapshot || text != sub.last[i]) {
+                    values[sub.fields[i]] = text;
+                    sub.last[i] = text;
+                }
+            }
+            sub.snapshot = false;
+            sub.version = version;
+            if (values.empty()) continue;
+
+            Json::Value msg;
+            msg["table"] = spec.table;
+            msg["version"] = version;
+            msg["values"] = values;
+            send(Json::writeString(writer_, msg));
+            lastPush_ = now;
+        }
+    }
+
+    void onTimer(beast::error_code ec) {
+        timerArmed_ = false;
+        if (!ec) flush();
+    }
+
+    void send(const std::string& message) {
+        out_.push_back(message);
+        if (!writing_) doWrite();
+    }
+
+    void doWrite() {
+        writing_ = true;
+        ws_.text(true);
+        ws_.async_write(net::buffer(out_.front()), beast::bind_front_handler(&WsSession::onWrite, shared_from_this()));
+    }
+
+    void onWrite(beast::error_code ec, std::size_t) {
+        if (ec) {
+            if (ec != websocket::error::closed && ec != net::error::operation_aborted) {
+                std::cerr << "WebSocket error: " << ec.message() << std::endl;
+            }
+            return;
+        }
+        out_.pop_front();
+        if (!reading_ && !closing_ && out_.size() < WS_OUT_LIMIT) doRead();
+        if (!out_.empty()) {
+            doWrite();
+            return;
+        }
+        writing_ = false;
+        if (closing_) doClose();
+        else if (flushPending_) flush();
+    }
+
+    void onShutdown() {
+        closing_ = true;
+        // 握手未完成时由 onAccept 关闭；有消息未写完时等 onWrite 写完再关闭
+        if (subscription_ && !writing_) doClose();
+    }
+
+    void doClose() {
+        if (closed_) return;
+        closed_ = true;
+        std::shared_ptr<WsSession> self = shared_from_this();
+        ws_.async_close(websocket::close_code::going_away, [self](beast::error_code) {});
+    }
+};
+
+// 解码 URL 查询参数中的 %xx 和 '+'
+static std::string urlDecode(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '+') {
+            out += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size() && isxdigit((unsigned char)text[i + 1]) &&
+                   isxdigit((unsigned char)text[i + 2])) {
+            out += char(std::stoi(text.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+// 请求目标的路径部分(去掉 ? 之后的查询参数)
+static std::string targetPath(const Request& req) {
+    std::string target(req.target());
+    return target.substr(0, target.find('?'));
+}
+
+// /api/stream 的请求参数
+struct StreamParams {
+    std::vector<int> frames;    // 订阅的帧(DeviceProfile::frames 下标)
+    int intervalMs = 0;         // 0 表示逐帧推送，否则每个间隔每张表最多推送一条最新帧
+    uint64_t lastEventId = 0;   // 断线重连时浏览器带回的最后事件 id，0 表示新连接
+};
+
+// 解析 /api/stream?tables=a,b&interval_ms=200 和 Last-Event-ID 头，出错时返回 false 和原因
+static bool parseStreamRequest(const Request& req, const LatestStore& store, StreamParams& params, std::string& err) {
+    std::string target(req.target());
+    size_t q = target.find('?');
+    std::string query = q == std::string::npos ? "" : target.substr(q + 1);
+    std::string tables;
+    std::string item;
+    std::istringstream items(query);
+    while (std::getline(items, item, '&')) {
+        size_t eq = item.find('=');
+        std::string key = urlDecode(item.substr(0, eq));
+        std::string value = eq == std::string::npos ? "" : urlDecode(item.substr(eq + 1));
+        if (key == "tables") {
+            tables = value;
+        } else if (key == "interval_ms") {
+            char* end = nullptr;
+            long ms = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end || ms < 0 || ms > SSE_MAX_INTERVAL_MS) {
+                err = "Invalid interval_ms: " + value;
+                return false;
+            }
+            params.intervalMs = int(ms);
+        }
+    }
+
+    // tables 省略时订阅全部帧
+    const DeviceProfile& profile = store.profile();
+    if (tables.empty()) {
+        for (size_t i = 0; i < profile.frames.size(); ++i) params.frames.push_back(int(i));
+    } else {
+        std::istringstream names(tables);
+        while (std::getline(names, item, ',')) {
+            if (item.empty()) continue;
+            int frame = profile.findFrame(item);
+            if (frame < 0) {
+                err = "Unknown table: " + item;
+                return false;
+            }
+            if (std::find(params.frames.begin(), params.frames.end(), frame) == params.frames.end()) {
+                params.frames.push_back(frame);
+            }
+        }
+    }
+
+    // id 不合法时按新连接处理
+    http::request_header<>::const_iterator it = req.find("Last-Event-ID");
+    if (it != req.end()) {
+        std::string id(it->value());
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(id.c_str(), &end, 10);
+        if (!id.empty() && !*end) params.lastEventId = value;
+    }
+    return true;
+}
+
+/*
+ * 事件流连接(GET /api/stream，Server-Sent Events)：
+ *   GET /api/stream?tables=lop1_frame1,lop2_frame&interval_ms=200
+ * tables 省略时订阅全部帧。每个事件对应一帧，id 为 FrameHistory 中的序号，内容为该帧全部字段和 received_time：
+ *   id: 123
+ *   data: {"table": "lop1_frame1", "values": {"rpm1": "1500", ...}}
+ * 新连接先按内存中的最新帧每张表推送一条(id 为当时的最新序号)；
+ * 带 Last-Event-ID 重连时从历史中补发之后的帧，补不全(已被覆盖)时改为推送一次最新帧。
+ * interval_ms 为 0 时逐帧推送，否则每个间隔内每张表只推送最后一帧。
+ * 空闲 SSE_HEARTBEAT_S 秒发一行心跳注释；客户端跟不上时按历史补发，落后超过历史容量则跳到最新帧。
+ * HTTP/1.1 用 chunked 编码，HTTP/1.0 直接写到连接关闭。
+ */
+class SseSession : public Session, public std::enable_shared_from_this<SseSession> {
+public:
+    SseSession(beast::tcp_stream&& stream, ServiceContext& ctx, const StreamParams& params)
+        : stream_(std::move(stream)), hub_(*ctx.hub), params_(params), wake_(std::make_shared<Wake>()),
+          timer_(stream_.get_executor()), heartbeat_(stream_.get_executor()) {
+        writer_["indentation"] = "";
+        for (int frame : params_.frames) wake_->add(frame);
+    }
+
+    ~SseSession() {
+        if (subscription_) hub_.unsubscribe(subscription_);
+    }
+
+    // 在原 HTTP 连接的 strand 上调用
+    void run(const Request& req) {
+        beast::error_code ec;
+        stream_.socket().set_option(net::socket_base::send_buffer_size(PUSH_SEND_BUFFER), ec);
+        subscription_ = subscribeWake(hub_, shared_from_this(), wake_, stream_.get_executor());
+
+        chunked_ = req.version() >= 11;
+        res_.version(req.version());
+        res_.result(http::status::ok);
+        setCors(res_);
+        res_.set(http::field::content_type, "text/event-stream");
+        res_.set(http::field::cache_control, "no-cache");
+        if (chunked_) res_.chunked(true);
+        else res_.keep_alive(false);
+        serializer_.reset(new http::response_serializer<http::empty_body>(res_));
+
+        writing_ = true;
+        stream_.expires_after(std::chrono::seconds(HttpService::IDLE_TIMEOUT_S));
+        http::async_write_header(stream_, *serializer_,
+                                 beast::bind_front_handler(&SseSession::onHeader, shared_from_this()));
+    }
+
+    void shutdown() override {
+        net::post(stream_.get_executor(), beast::bind_front_handler(&SseSession::onShutdown, shared_from_this()));
+    }
+
+    // 有订阅的帧更新后在本连接的 strand 上执行
+    void onWake() {
+        flush();
+    }
+
+private:
+    beast::tcp_stream stream_;
+    RealtimeHub& hub_;
+    StreamParams params_;
+    std::shared_ptr<Wake> wake_;
+    int subscription_ = 0;
+    http::response<http::empty_body> res_;
+    std::unique_ptr<http::response_serializer<http::empty_body>> serializer_;
+    bool chunked_ = false;
+    uint64_t cursor_ = 0;           // 已推送到的历史序号
+    std::vector<FrameHistory::Entry> batch_;
+    std::deque<std::string> out_;
+    Json::StreamWriterBuilder writer_;
+    net::steady_timer timer_;
+    net::steady_timer heartbeat_;
+    std::chrono::steady_clock::time_point lastPush_;
+    std::chrono::steady_clock::time_point lastWrite_;
+    bool writing_ = false;
+    bool flushPending_ = false;     // 写完后继续推送
+    bool timerArmed_ = false;
+    bool closing_ = false;
+    bool closed_ = false;
+
+    void onHeader(beast::error_code ec, std::size_t) {
+        writing_ = false;
+        if (ec) {
+            std::cerr << "Stream error: " << ec.message() << std::endl;
+            return;
+        }
+        if (closing_) {
+            doClose();
+            return;
+        }
+        // 浏览器断线后 2 秒重连
+        send("retry: 2000\n\n");
+        // 服务重启后序号从头开始，比当前序号大的 id 也按新连接处理
+        bool gap = true;
+        if (params_.lastEventId && params_.lastEventId <= hub_.history().lastSeq()) {
+            hub_.history().since(params_.lastEventId, batch_, 0, &gap);
+            if (!gap) cursor_ = params_.lastEventId;
+        }
+        if (gap) snapshot();
+        armHeartbeat();
+        flush();
+    }
+
+    // 每张表推送一次内存中的最新帧，之后从当时的最新序号继续
+    void snapshot() {
+        cursor_ = hub_.history().lastSeq();
+        lastPush_ = std::chrono::steady_clock::now();
+        const LatestStore& store = hub_.store();
+        DecodedFrame frame;
+        std::string text;
+        for (int index : params_.frames) {
+            if (store.latest(index, frame)) text += event(cursor_, frame);
+        }
+        if (!text.empty()) send(text);
+    }
+
+    std::string event(uint64_t id, const DecodedFrame& frame) {
+        const FrameSpec& spec = hub_.store().profile().frames[frame.frame];
+        Json::Value values(Json::objectValue);
+        std::string text;
+        for (const FieldSpec& field : spec.fields) {
+            latestFieldText(spec, frame, field.column, text);
+            values[field.column] = text;
+        }
+        latestFieldText(spec, frame, "received_time", text);
+        values["received_time"] = text;
+
+        Json::Value msg;
+        msg["table"] = spec.table;
+        msg["values"] = values;
+        return "id: " + std::to_string(id) + "\ndata: " + Json::writeString(writer_, msg) + "\n\n";
+    }
+
+    bool subscribed(int frame) const {
+        return std::find(params_.frames.begin(), params_.frames.end(), frame) != params_.frames.end();
+    }
+
+    // 把历史中 cursor_ 之后订阅的帧写出；正在写时推迟到写完，合并模式下离上次推送太近时推迟到间隔结束
+    void flush() {
+        wake_->dirty.store(false);
+        if (closing_) return;
+        if (writing_) {
+            flushPending_ = true;
+            return;
+        }
+        flushPending_ = false;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (params_.intervalMs > 0) {
+            std::chrono::steady_clock::time_point next = lastPush_ + std::chrono::milliseconds(params_.intervalMs);
+            if (now < next) {
+                if (!timerArmed_) {
+                    timerArmed_ = true;
+                    timer_.expires_at(next);
+                    timer_.async_wait(beast::bind_front_handler(&SseSession::onTimer, shared_from_this()));
+                }
+                return;
+            }
+        }
+
+        bool gap = false;
+        const FrameHistory& history = hub_.history();
+        std::string text;
+        if (params_.intervalMs == 0) {
+            // 逐帧：一次最多写 SSE_BATCH 个事件，剩下的写完再取
+            history.since(cursor_, batch_, SSE_BATCH, &gap);
+            if (gap) {
+                snapshot();
+                return;
+            }
+            for (const FrameHistory::Entry& entry : batch_) {
+                if (subscribed(entry.frame.frame)) text += event(entry.seq, entry.frame);
+                cursor_ = entry.seq;
+            }
+            if (batch_.size() == SSE_BATCH) flushPending_ = true;
+        } else {
+            // 合并：每张表只留间隔内的最后一帧，按序号顺序写出
+            std::vector<FrameHistory::Entry> last;
+            do {
+                history.since(cursor_, batch_, SSE_BATCH, &gap);
+                if (gap) {
+                    snapshot();
+                    return;
+                }
+                for (const FrameHistory::Entry& entry : batch_) {
+                    cursor_ = entry.seq;
+                    if (!subscribed(entry.frame.frame)) continue;
+                    size_t i = 0;
+                    while (i < last.size() && last[i].frame.frame != entry.frame.frame) ++i;
+                    if (i < last.size()) last.erase(last.begin() + i);
+                    last.push_back(entry);
+                }
+            } while (batch_.size() == SSE_BATCH);
+            for (const FrameHistory::Entry& entry : last) text += event(entry.seq, entry.frame);
+        }
+        if (text.empty()) return;
+        lastPush_ = now;
+        send(text);
+    }
+
+    void onTimer(beast::error_code ec) {
+        timerArmed_ = false;
+        if (!ec) flush();
+    }
+
+    void armHeartbeat() {
+        heartbeat_.expires_at(lastWrite_ + std::chrono::seconds(SSE_HEARTBEAT_S));
+        heartbeat_.async_wait(beast::bind_front_handler(&SseSession::onHeartbeat, shared_from_this()));
+    }
+
+    void onHeartbeat(beast::error_code ec) {
+        if (ec || closing_) return;
+        if (!writing_ && std::chrono::steady_clock::now() >= lastWrite_ + std::chrono::seconds(SSE_HEARTBEAT_S)) {
+            send(": ping\n\n");
+        }
+        armHeartbeat();
+    }
+
+    void send(const std::string& text) {
+        if (chunked_) {
+            std::ostringstream chunk;
+            chunk << std::hex << text.size() << "\r\n" << text << "\r\n";
+            out_.push_back(chunk.str());
+        } else {
+            out_.push_back(text);
+        }
+        lastWrite_ = std::chrono::steady_clock::now();
+        if (!writing_) doWrite();
+    }
+
+    void doWrite() {
+        writing_ = true;
+        // 客户端长时间不收数据时由超时关闭
+        stream_.expires_after(std::chrono::seconds(HttpService::IDLE_TIMEOUT_S));
+        net::async_write(stream_, net::buffer(out_.front()),
+                         beast::bind_front_handler(&SseSession::onWrite, shared_from_this()));
+    }
+
+    void onWrite(beast::error_code ec, std::size_t) {
+        if (ec) {
+            // 浏览器关闭页面、超时和退出时的取消属于正常断开
+            if (ec != beast::error::timeout && ec != net::error::operation_aborted &&
+                ec != net::error::broken_pipe && ec != net::error::connection_reset) {
+                std::cerr << "Stream error: " << ec.message() << std::endl;
+            }
+            beast::error_code ignored;
+            timer_.cancel(ignored);
+            heartbeat_.cancel(ignored);
+            return;
+        }
+        out_.pop_front();
+        if (!out_.empty()) {
+            doWrite();
+            return;
+        }
+        writing_ = false;
+        if (closing_) doClose();
+        else if (flushPending_) flush();
+    }
+
+    void onShutdown() {
+        closing_ = true;
+        beast::error_code ec;
+        timer_.cancel(ec);
+        heartbeat_.cancel(ec);
+        // 有数据未写完时等 onWrite 写完再关闭
+        if (!writing_) doClose();
+    }
+
+    // chunked 时先写结束块，再关闭发送方向
+    void doClose() {
+        if (closed_) return;
+        closed_ = true;
+        stream_.expires_never();
+        if (!chunked_) {
+            beast::error_code ec;
+            stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+            return;
+        }
+        static const char LAST_CHUNK[] = "0\r\n\r\n";
+        std::shared_ptr<SseSession> self = shared_from_this();
+        stream_.expires_after(std::chrono::seconds(HttpService::SHUTDOWN_GRACE_S));
+        net::async_write(stream_, net::buffer(LAST_CHUNK, sizeof(LAST_CHUNK) - 1), [self](beast::error_code, std::size_t) {
+            beast::error_code ec;
+            self->stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+        });
+    }
+};
+
+/*
+ * 一个 HTTP 连接，所有回调都在本连接的 strand 上执行。
+ * 读到请求立即生成应答放入队列，队列未满时继续读下一个请求(流水线)，
+ * 应答按请求顺序逐个写出；请求不要求 keep-alive、对端关闭或服务退出时写完队列再关闭。
+ * 流式导出的应答每写完一段再从语句取下一段，服务退出时在下一段以错误结尾收尾。
+ * /ws/realtime 的升级请求把连接交给 WsSession，GET /api/stream 把连接交给 SseSession。
+ */
+class HttpSession : public Session, public std::enable_shared_from_this<HttpSession> {
+public:
+    HttpSession(tcp::socket&& socket, ServiceContext& ctx)
+        : stream_(std::move(socket)), ctx_(ctx) {
+    }
+
+    void run() {
+        net::dispatch(stream_.get_executor(), beast::bind_front_handler(&HttpSession::doRead, shared_from_this()));
+    }
+
+    void shutdown() override {
+        net::post(stream_.get_executor(), beast::bind_front_handler(&HttpSession::onShutdown, shared_from_this()));
+    }
+
+private:
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    boost::optional<http::request_parser<http::string_body>> parser_;
+    std::deque<Reply> queue_;
+    ServiceContext& ctx_;
+    bool reading_ = false;
+    bool writing_ = false;
+    bool closing_ = false;      // 不再读新请求，队列写完后关闭
+    bool stopping_ = false;     // 服务退出，流式应答提前收尾
+    bool upgraded_ = false;     // 连接已交给 WsSession 或 SseSession
+
+    void doRead() {
+        parser_.emplace();
+        parser_->body_limit(BODY_LIMIT);
+        reading_ = true;
+        stream_.expires_after(std::chrono::seconds(HttpService::IDLE_TIMEOUT_S));
+        http::async_read(stream_, buffer_, *parser_, beast::bind_front_handler(&HttpSession::onRead, shared_from_this()));
+    }
+
+    void onRead(beast::error_code ec, std::size_t) {
+        reading_ = false;
+        if (ec == http::error::end_of_stream) {
+            closing_ = true;
+            if (!writing_) doClose();
+            return;
+        }
+        if (ec) {
+            // 超时和退出时的取消属于正常关闭
+            if (ec != beast::error::timeout && ec != net::error::operation_aborted) {
+                std::cerr << "Session error: " << ec.message() << std::endl;
+            }
+            return;
+        }
+
+        const Request& req = parser_->get();
+        Reply res;
+        if (websocket::is_upgrade(req)) {
+            if (req.target() != "/ws/realtime" || !ctx_.hub) {
+                res.res = textResponse(req, http::status::not_found, "Unknown endpoint");
+            } else if (closing_ || !queue_.empty()) {
+                res.res = textResponse(req, http::status::service_unavailable, "Busy");
+            } else {
+                upgraded_ = true;
+                std::shared_ptr<WsSession> ws = std::make_shared<WsSession>(std::move(stream_), ctx_);
+                ws->run(req);
+                ctx_.add(ws);
+                return;
+            }
+        } else if (req.method() == http::verb::get && targetPath(req) == "/api/stream") {
+            StreamParams params;
+            std::string err;
+            if (!ctx_.hub) {
+                res.res = textResponse(req, http::status::not_found, "Unknown endpoint");
+            } else if (!parseStreamRequest(req, ctx_.hub->store(), params, err)) {
+                res.res = textResponse(req, http::status::bad_request, err);
+            } else if (closing_ || !queue_.empty()) {
+                res.res = textResponse(req, http::status::service_unavailable, "Busy");
+            } else {
+                upgraded_ = true;
+                std::shared_ptr<SseSession> sse = std::make_shared<SseSession>(std::move(stream_), ctx_, params);
+                sse->run(req);
+                ctx_.add(sse);
+                return;
+            }
+        } else {
+            try {
+                if (req.method() == http::verb::post && req.target() == "/api/data/export") {
+                    res = handleExport(req, ctx_.dbPath, ctx_.exportPool);
+                } else {
+                    res.res = handleRequest(req, ctx_.dbPath, ctx_.latest, ctx_.pool);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Session error: " << e.what() << std::endl;
+                res.stream.reset();
+                res.res = textResponse(req, http::status::internal_server_error, "Internal error");
+            }
+        }
+        if (closing_) res.close();
+        if (!res.keepAlive()) closing_ = true;
+
+        queue_.push_back(res);
+        if (!writing_) doWrite();
+        if (!closing_ && queue_.size() < size_t(HttpService::PIPELINE_LIMIT)) doRead();
+    }
+
+    void doWrite() {
+        writing_ = true;
+        const Reply& reply = queue_.front();
+        if (reply.stream) {
+            StreamReply& s = *reply.stream;
+            s.serializer.reset(new http::response_serializer<http::empty_body>(s.head));
+            stream_.expires_after(std::chrono::seconds(HttpService::IDLE_TIMEOUT_S));
+            http::async_write_header(stream_, *s.serializer,
+                                     beast::bind_front_handler(&HttpSession::onStreamWrite, shared_from_this()));
+            return;
+        }
+        http::async_write(stream_, *reply.res, beast::bind_front_handler(&HttpSession::onWrite, shared_from_this()));
+    }
+
+    // 流式应答写完一段(或头部)后取下一段，内存中只有一段；正文取完后写结束块，再按普通应答写完处理
+    void onStreamWrite(beast::error_code ec, std::size_t) {
+        StreamReply& s = *queue_.front().stream;
+        if (ec || s.finished) {
+            onWrite(ec, 0);
+            return;
+        }
+        if (stopping_) s.body->cancel("Server shutting down");
+        bool chunked = s.head.chunked();
+        s.text.clear();
+        if (s.body->next(s.text, EXPORT_CHUNK)) {
+            if (chunked) {
+                std::ostringstream size;
+                size << std::hex << s.text.size() << "\r\n";
+                s.size = size.str();
+                s.text += "\r\n";
+            }
+        } else {
+            s.finished = true;
+            if (!chunked) {
+                onWrite(ec, 0);
+                return;
+            }
+            s.size = "0\r\n\r\n";
+        }
+        // 客户端长时间不收数据时由超时关闭
+        stream_.expires_after(std::chrono::seconds(HttpService::IDLE_TIMEOUT_S));
+        std::array<net::const_buffer, 2> buffers = {{net::buffer(s.size), net::buffer(s.text)}};
+        net::async_write(stream_, buffers, beast::bind_front_handler(&HttpSession::onStreamWrite, shared_from_this()));
+    }
+
+    void onWrite(beast::error_code ec, std::size_t) {
+        if (ec) {
+            std::cerr << "Session error: " << ec.message() << std::endl;
+            return;
+        }
+        queue_.pop_front();
+        // 队列满时暂停了读取，腾出位置后恢复
+        if (!closing_ && !reading_ && queue_.size() < size_t(HttpService::PIPELINE_LIMIT)) doRead();
+        if (!queue_.empty()) {
+            doWrite();
+            return;
+        }
+        writing_ = false;
+        if (closing_) doClose();
+    }
+
+    void onShutdown() {
+        if (upgraded_) return;
+        closing_ = true;
+        stopping_ = true;
+        // 空闲连接直接取消读取；有应答未写完时等 onWrite 写完再关闭
+        if (!writing_) doClose();
+    }
+
+    void doClose() {
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+        if (reading_) stream_.cancel();
+    }
+};
+
+struct HttpService::Impl {
+    unsigned short port;
+    unsigned threads;
+    ServiceContext ctx;
+    ReadPool pool;
+    ReadPool exportPool;
+
+    net::io_context ioc;
+    tcp::acceptor acceptor;
+    net::signal_set signals;
+    net::steady_timer graceTimer;
+    std::chrono::steady_clock::time_point graceDeadline;
+    std::atomic<bool> stopping;
+
+    Impl(unsigned short port, const std::string& dbPath, const LatestStore* latest, RealtimeHub* hub, unsigned threads)
+        : port(port), threads(threads),
+          pool(dbPath, threads, registerAlarmFunctions),
+          exportPool(dbPath, HttpService::EXPORT_STREAMS, registerAlarmFunctions),
+          ioc(int(threads)), acceptor(net::make_strand(ioc)), signals(ioc, SIGINT, SIGTERM), graceTimer(ioc),
+          stopping(false) {
+        ctx.dbPath = dbPath;
+        ctx.latest = latest;
+        ctx.hub = hub;
+        ctx.pool = &pool;
+        ctx.exportPool = &exportPool;
+    }
+
+    void doAccept() {
+        acceptor.async_accept(net::make_strand(ioc), beast::bind_front_handler(&Impl::onAccept, this));
+    }
+
+    void onAccept(beast::error_code ec, tcp::socket socket) {
+        if (stopping) return;
+        if (ec) {
+            std::cerr << "Accept error: " << ec.message() << std::endl;
+        } else {
+            std::shared_ptr<HttpSession> session = std::make_shared<HttpSession>(std::move(socket), ctx);
+            ctx.add(session);
+            session->run();
+        }
+        doAccept();
+    }
+
+    // 在 acceptor 的 strand 上执行：停止接受新连接，通知各连接关闭
+    void onStop() {
+        beast::error_code ec;
+        acceptor.close(ec);
+        signals.cancel(ec);
+        ctx.shutdownAll();
+        graceDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(HttpService::SHUTDOWN_GRACE_S);
+        waitSessions();
+    }
+
+    // 每 100ms 检查一次，连接全部关闭后 io_context 自然退出，超时则强制停止
+    void waitSessions() {
+        if (!ctx.live()) return;
+        if (std::chrono::steady_clock::now() >= graceDeadline) {
+            std::cerr << "HTTP shutdown timed out, closing remaining connections" << std::endl;
+            ioc.stop();
+            return;
+        }
+        graceTimer.expires_after(std::chrono::milliseconds(100));
+        graceTimer.async_wait([this](beast::error_code ec) {
+            if (!ec) waitSessions();
+        });
+    }
+
+    void runLoop() {
+        while (true) {
+            try {
+                ioc.run();
+                return;
+            } catch (const std::exception& e) {
+                std::cerr << "HTTP worker error: " << e.what() << std::endl;
+            }
+        }
+    }
+};
+
+HttpService::HttpService(unsigned short port, const std::string& dbPath, const LatestStore* latest,
+                         RealtimeHub* hub, unsigned threads)
+    : impl_(new Impl(port, dbPath, latest, hub,
+                     threads ? threads : std::max(1u, std::thread::hardware_concurrency()))) {
+}
+
+HttpService::~HttpService() {
+}
+
+int HttpService::run() {
+    Impl& s = *impl_;
+    beast::error_code ec;
+    tcp::endpoint endpoint(tcp::v4(), s.port);
+    s.acceptor.open(endpoint.protocol(), ec);
+    if (!ec) s.acceptor.set_option(net::socket_base::reuse_address(true), ec);
+    if (!ec) s.acceptor.bind(endpoint, ec);
+    if (!ec) s.acceptor.listen(net::socket_base::max_listen_connections, ec);
+    if (ec) {
+        std::cerr << "Fatal error: " << ec.message() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    s.signals.async_wait([this](beast::error_code ec, int) {
+        if (!ec) stop();
+    });
+    s.doAccept();
+    std::cout << "HTTP server started at http://0.0.0.0:" << s.port << " (" << s.threads << " threads)" << std::endl;
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < s.threads; ++i) workers.push_back(std::thread(&Impl::runLoop, &s));
+    s.runLoop();
+    for (std::thread& t : workers) t.join();
+    std::cout << "HTTP server stopped" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+ReadPool& HttpService::readPool() {
+    return impl_->pool;
+}
+
+void HttpService::stop() {
+    if (impl_->stopping.exchange(true)) return;
+    net::post(impl_->acceptor.get_executor(), std::bind(&Impl::onStop, impl_.get()));
+}
+
+int runHttpService(unsigned short port, const std::string& dbPath, const LatestStore* latest, RealtimeHub* hub) {
+    HttpService service(port, dbPath, latest, hub);
+    return service.run();
+}
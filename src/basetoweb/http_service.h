@@ -0,0 +1,56 @@
+// http_service.h
+#pragma once
+
+#include <memory>
+#include <string>
+
+class LatestStore;
+class RealtimeHub;
+class ReadPool;
+
+/*
+ * 网页数据接口(HTTP，端口 port)：
+ *   POST /api/data/realtime、/api/data/query、/api/data/delete，请求和响应均为 JSON，
+ *   所有响应带 CORS 头，OPTIONS 预检直接返回 200。
+ *   POST /api/data/export 的请求和应答与 /api/data/query 相同，但正文边查边写(HTTP/1.1 为 chunked)，
+ *   大批量导出时内存占用固定、第一行立即发出；同时最多 EXPORT_STREAMS 个，超出时返回 Database busy 错误。
+ * latest 非空时实时接口优先从内存取当前值；
+ * hub 非空时提供 WebSocket 推送通道 /ws/realtime 和 SSE 事件流 GET /api/stream
+ * (协议见 http_service.cpp 中的 WsSession、SseSession)。
+ *
+ * 异步收发：固定数量的 io_context 线程(默认等于 CPU 核数)，每个连接一个 strand，
+ * 支持 HTTP/1.1 keep-alive 和流水线(同一连接最多 PIPELINE_LIMIT 个请求排队等待应答)，
+ * 连接空闲 IDLE_TIMEOUT_S 秒后关闭。
+ * 历史查询共用一个只读连接池(连接数等于线程数)，每个线程同一时刻只占用一个连接；
+ * 流式导出写完前一直占用连接，另用一个 EXPORT_STREAMS 个连接的池。
+ * stop() 或 SIGINT/SIGTERM 时优雅退出：不再接受新连接，空闲连接和推送连接立即关闭，
+ * 正在处理的请求写完应答后关闭，最多等 SHUTDOWN_GRACE_S 秒。
+ */
+class HttpService {
+public:
+    static const int IDLE_TIMEOUT_S = 30;
+    static const int PIPELINE_LIMIT = 8;
+    static const int SHUTDOWN_GRACE_S = 5;
+    static const int EXPORT_STREAMS = 2;
+
+    // threads 为 0 时取 CPU 核数；latest、hub 需在本对象存续期间有效
+    HttpService(unsigned short port, const std::string& dbPath, const LatestStore* latest = nullptr,
+                RealtimeHub* hub = nullptr, unsigned threads = 0);
+    ~HttpService();
+
+    // 阻塞运行到 stop() 或收到 SIGINT/SIGTERM，出错时返回非 0
+    int run();
+    // 可在任意线程调用
+    void stop();
+
+    // 查询连接池，可在任意线程读取统计
+    ReadPool& readPool();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// 在当前线程运行 HttpService，直到收到 SIGINT/SIGTERM
+int runHttpService(unsigned short port, const std::string& dbPath, const LatestStore* latest = nullptr,
+                   RealtimeHub* hub = nullptr);
@@ -0,0 +1,74 @@
+// latest_store.cpp
+#include "latest_store.h"
+#include <cstring>
+
+LatestStore::LatestStore(const DeviceProfile& profile)
+    : profile_(profile), slots_(new Slot[profile.frames.size()]), slotCount_(profile.frames.size()) {
+    for (size_t i = 0; i < slotCount_; ++i) {
+        slots_[i].seq.store(0, std::memory_order_relaxed);
+        slots_[i].updates.store(0, std::memory_order_relaxed);
+        for (size_t w = 0; w < WORDS; ++w) slots_[i].words[w].store(0, std::memory_order_relaxed);
+        slots_[i].storedMonoNs = 0;
+        slots_[i].storedRowId = 0;
+    }
+}
+
+void LatestStore::update(const DecodedFrame& frame) {
+    if (frame.frame < 0 || frame.frame >= int(slotCount_)) return;
+    Slot& slot = slots_[frame.frame];
+
+    uint64_t buf[WORDS];
+    buf[WORDS - 1] = 0;
+    std::memcpy(buf, &frame, sizeof(DecodedFrame));
+
+    std::lock_guard<std::mutex> lock(slot.writeMutex);
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t w = 0; w < WORDS; ++w) slot.words[w].store(buf[w], std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+    slot.updates.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool LatestStore::latest(int frame, DecodedFrame& out) const {
+    if (frame < 0 || frame >= int(slotCount_)) return false;
+    const Slot& slot = slots_[frame];
+    if (slot.updates.load(std::memory_order_acquire) == 0) return false;
+
+    uint64_t buf[WORDS];
+    while (true) {
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        for (size_t w = 0; w < WORDS; ++w) buf[w] = slot.words[w].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before) break;
+    }
+    std::memcpy(&out, buf, sizeof(DecodedFrame));
+    return true;
+}
+
+bool LatestStore::latest(const std::string& table, DecodedFrame& out) const {
+    return latest(profile_.findFrame(table), out);
+}
+
+uint32_t LatestStore::version(int frame) const {
+    if (frame < 0 || frame >= int(slotCount_)) return 0;
+    return slots_[frame].updates.load(std::memory_order_relaxed);
+}
+
+void LatestStore::stored(int frame, int64_t monoNs, int64_t rowId) {
+    if (frame < 0 || frame >= int(slotCount_) || rowId <= 0) return;
+    Slot& slot = slots_[frame];
+    std::lock_guard<std::mutex> lock(slot.rowMutex);
+    slot.storedMonoNs = monoNs;
+    slot.storedRowId = rowId;
+}
+
+bool LatestStore::rowId(int frame, int64_t monoNs, int64_t& rowId) const {
+    if (frame < 0 || frame >= int(slotCount_)) return false;
+    const Slot& slot = slots_[frame];
+    std::lock_guard<std::mutex> lock(slot.rowMutex);
+    if (slot.storedRowId == 0) return false;
+    rowId = slot.storedMonoNs == monoNs ? slot.storedRowId : 0;
+    return true;
+}
@@ -0,0 +1,58 @@
+// latest_store.h
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "device_profile.h"
+#include "decode_program.h"
+
+/*
+ * 各帧的最新一帧(内存)：采集线程每解码一帧就更新，
+ * 同一进程内的实时接口直接从这里取当前值，不经过 SQLite。
+ *
+ * 每种帧一个 seqlock 槽：写入时序号先变奇数、拷贝、再变偶数；
+ * 读取时序号为偶数且拷贝前后不变才算读到完整一帧，否则重读。
+ * 读者不加锁、不阻塞采集线程；同一种帧可能来自多个端口，写者之间用互斥锁排队。
+ * 帧内容按 64 位原子字逐字拷贝，读写并发时没有数据竞争。
+ */
+class LatestStore {
+public:
+    // profile 需在本对象存续期间有效
+    explicit LatestStore(const DeviceProfile& profile);
+
+    const DeviceProfile& profile() const { return profile_; }
+
+    void update(const DecodedFrame& frame);
+    // 按表名取最新一帧，表不存在或尚未收到数据返回 false
+    bool latest(const std::string& table, DecodedFrame& out) const;
+    bool latest(int frame, DecodedFrame& out) const;
+
+    // 某种帧的更新次数，0 表示尚未收到
+    uint32_t version(int frame) const;
+
+    // 写库线程提交后登记某帧在库中的行号(id)，帧以接收单调时间区分
+    void stored(int frame, int64_t monoNs, int64_t rowId);
+    // 取接收单调时间为 monoNs 的帧的行号，尚未写入库时 rowId 为 0；
+    // 该种帧从未登记过行号(没有写库线程登记)时返回 false
+    bool rowId(int frame, int64_t monoNs, int64_t& rowId) const;
+
+private:
+    static const size_t WORDS = (sizeof(DecodedFrame) + 7) / 8;
+
+    struct Slot {
+        std::atomic<uint32_t> seq;      // 奇数：正在写
+        std::atomic<uint32_t> updates;
+        std::atomic<uint64_t> words[WORDS];
+        std::mutex writeMutex;
+        mutable std::mutex rowMutex;    // 保护下面两项，只在写库线程登记和查询 id 时使用
+        int64_t storedMonoNs;
+        int64_t storedRowId;            // 0 表示从未登记
+    };
+
+    const DeviceProfile& profile_;
+    std::unique_ptr<Slot[]> slots_;     // 与 profile.frames 下标一致
+    size_t slotCount_;
+};
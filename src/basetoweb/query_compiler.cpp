@@ -0,0 +1,395 @@
+// query_compiler.cpp
+#include "query_compiler.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include "alarm_table.h"
+
+const char* const FRAME_HEX_FIELD = "frame_hex";
+const char* const ALARM_TEXT_FIELD = "active_alarms";
+// 原始帧在库中以 BLOB 存放，对外仍以 frame_hex 字段提供十六进制文本
+static const char* FRAME_COLUMN = "frame";
+static const char* ALARM_NAME_FIELD = "alarm_name";
+// 时间范围过滤的列
+static const char* TIME_COLUMN = "received_time";
+static const char* ID_COLUMN = "id";
+
+bool TableSchemas::refresh(sqlite3* db, std::string& err) {
+    sqlite3_stmt* stmt = nullptr;
+    int version = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA schema_version;", -1, &stmt, nullptr) != SQLITE_OK) {
+        err = sqlite3_errmsg(db);
+        return false;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) version = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    if (version == version_) return true;
+
+    std::vector<std::string> names;
+    if (sqlite3_prepare_v2(db, "SELECT name FROM sqlite_master WHERE type IN ('table', 'view');", -1, &stmt,
+                           nullptr) != SQLITE_OK) {
+        err = sqlite3_errmsg(db);
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+
+    tables_.clear();
+    for (const std::string& name : names) {
+        char* sql = sqlite3_mprintf("PRAGMA table_info(\"%w\");", name.c_str());
+        int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+        sqlite3_free(sql);
+        if (rc != SQLITE_OK) {
+            err = sqlite3_errmsg(db);
+            return false;
+        }
+        std::vector<std::string>& columns = tables_[name];
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            columns.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+        }
+        sqlite3_finalize(stmt);
+    }
+    version_ = version;
+    return true;
+}
+
+bool TableSchemas::hasTable(const std::string& table) const {
+    return tables_.find(table) != tables_.end();
+}
+
+bool TableSchemas::hasColumn(const std::string& table, const std::string& column) const {
+    std::map<std::string, std::vector<std::string>>::const_iterator it = tables_.find(table);
+    return it != tables_.end() && std::find(it->second.begin(), it->second.end(), column) != it->second.end();
+}
+
+// 标识符已按库中实际的表名、列名校验，仍加引号，列名含中文时也不依赖 SQLite 的宽松解析
+static std::string quoteIdent(const std::string& name) {
+    std::string out = "\"";
+    for (char c : name) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// 字符串字面量：单引号成对转义，表名来自配置文件，不能原样拼进 SQL
+static std::string quoteLiteral(const std::string& text) {
+    std::string out = "'";
+    for (char c : text) {
+        if (c == '\'') out += '\'';
+        out += c;
+    }
+    return out + "'";
+}
+
+static bool isAlarmSource(const std::string& table) {
+    if (findAlarmTable(table)) return true;
+    return table == "lop1_frame1" || table == "lop1_frame2" || table == "lop2_frame";
+}
+
+// 请求字段到查询表达式：frame_hex 取 BLOB 列，报警文本由报警位解析(旧数据仍用原 JSON 列)；字段不存在返回 false
+static bool selectExpr(const TableSchemas& schemas, const std::string& table, const std::string& field,
+                       std::string& expr) {
+    if (field == FRAME_HEX_FIELD && schemas.hasColumn(table, FRAME_COLUMN)) {
+        expr = FRAME_COLUMN;
+        return true;
+    }
+    if (field == ALARM_TEXT_FIELD && isAlarmSource(table) && schemas.hasColumn(table, "alarm_bits")) {
+        std::string hi = schemas.hasColumn(table, "alarm_bits_hi") ? "alarm_bits_hi" : "0";
+        std::string old = schemas.hasColumn(table, ALARM_TEXT_FIELD) ? ALARM_TEXT_FIELD : "NULL";
+        // 表名作为报警表的查找键，以字面量写入 SQL(不占绑定位置，翻页时 SQL 文本不变)
+        expr = "CASE WHEN alarm_bits IS NULL THEN " + old + " ELSE alarm_text(" + quoteLiteral(table) + ", alarm_bits, "
+             + hi + ") END";
+        return true;
+    }
+    if (field == ALARM_NAME_FIELD && table == "alarm_events") {
+        expr = "alarm_name(source, bit)";
+        return true;
+    }
+    if (!schemas.hasColumn(table, field)) return false;
+    expr = quoteIdent(field);
+    return true;
+}
+
+// 条件运算符白名单
+static const char* compareOp(const std::string& op) {
+    static const char* const ops[] = {"=", "!=", "<>", "<", "<=", ">", ">="};
+    for (const char* known : ops) {
+        if (op == known) return known;
+    }
+    std::string upper = op;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    if (upper == "LIKE") return "LIKE";
+    return nullptr;
+}
+
+// 游标：最后一行的 (received_time, id)，十六进制编码，客户端不解析
+std::string encodeCursor(const std::string& time, const std::string& id) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text = time + "|" + id;
+    std::string out;
+    for (unsigned char c : text) {
+        out += digits[c >> 4];
+        out += digits[c & 0x0F];
+    }
+    return out;
+}
+
+static bool decodeCursor(const std::string& cursor, std::string& time, int64_t& id) {
+    if (cursor.size() % 2) return false;
+    std::string text;
+    for (size_t i = 0; i < cursor.size(); i += 2) {
+        if (!isxdigit((unsigned char)cursor[i]) || !isxdigit((unsigned char)cursor[i + 1])) return false;
+        text += char(std::stoi(cursor.substr(i, 2), nullptr, 16));
+    }
+    size_t sep = text.rfind('|');
+    if (sep == std::string::npos || sep + 1 == text.size()) return false;
+    char* end = nullptr;
+    long long value = std::strtoll(text.c_str() + sep + 1, &end, 10);
+    if (*end) return false;
+    time = text.substr(0, sep);
+    id = value;
+    return true;
+}
+
+static QueryValue textValue(const std::string& text) {
+    QueryValue v;
+    v.isInt = false;
+    v.i = 0;
+    v.text = text;
+    return v;
+}
+
+static QueryValue intValue(int64_t i) {
+    QueryValue v;
+    v.isInt = true;
+    v.i = i;
+    return v;
+}
+
+/*
+ * 游标翻页的时间条件：降序时下一页为 (received_time, id) < 游标，升序时为 > 游标。
+ * 靠近游标一侧的时间边界并入同一个行值比较(取更严的一个)，另一侧仍为普通比较，
+ * 这样 SQLite 从游标处沿 received_time 索引定位，而不是从时间范围的一端扫过前面所有页。
+ */
+static void keysetWhere(bool descending, const std::string& start, const std::string& end,
+                        const std::string& cursorTime, int64_t cursorId,
+                        std::vector<std::string>& where_clauses, std::vector<QueryValue>& values) {
+    const std::string& near = descending ? end : start;
+    const std::string& far = descending ? start : end;
+    if (!far.empty()) {
+        where_clauses.push_back(std::string(TIME_COLUMN) + (descending ? " >= ?" : " <= ?"));
+        values.push_back(textValue(far));
+    }
+
+    std::string boundTime = cursorTime;
+    int64_t boundId = cursorId;
+    bool hasBound = !cursorTime.empty();
+    if (!near.empty() && (!hasBound || (descending ? near < cursorTime : near > cursorTime))) {
+        // 时间边界上的所有行都在范围内
+        boundTime = near;
+        boundId = descending ? INT64_MAX : INT64_MIN;
+        hasBound = true;
+    }
+    if (!hasBound) return;
+    where_clauses.push_back(std::string("(") + TIME_COLUMN + ", " + ID_COLUMN + (descending ? ") < (?, ?)" : ") > (?, ?)"));
+    values.push_back(textValue(boundTime));
+    values.push_back(intValue(boundId));
+}
+
+static bool compileRequest(const Json::Value& request, const TableSchemas& schemas, CompiledQuery& out,
+                           std::string& err) {
+    out.sql.clear();
+    out.values.clear();
+    out.hiddenColumns = 0;
+    out.limit = -1;
+
+    std::string table = request["table"].asString();
+    const Json::Value& fields = request["fields"];
+    if (!fields.isArray() || fields.empty()) {
+        err = "Fields array missing or invalid.";
+        return false;
+    }
+    if (!schemas.hasTable(table)) {
+        err = "Unknown table: " + table;
+        return false;
+    }
+
+    // pagination 带 cursor(首页为空串)时按 (received_time, id) 游标翻页
+    const Json::Value& pagination = request["pagination"];
+    bool keyset = pagination.isObject() && pagination.isMember("cursor");
+    std::string cursorTime;
+    int64_t cursorId = 0;
+    if (keyset) {
+        if (!schemas.hasColumn(table, TIME_COLUMN) || !schemas.hasColumn(table, ID_COLUMN)) {
+            err = "Cursor pagination needs received_time and id";
+            return false;
+        }
+        std::string cursor = pagination["cursor"].asString();
+        if (!cursor.empty() && !decodeCursor(cursor, cursorTime, cursorId)) {
+            err = "Invalid cursor";
+            return false;
+        }
+    }
+
+    std::string sql;
+    bool useAllFields = (fields.size() == 1 && fields[0].isString() && fields[0].asString() == "*");
+    if (useAllFields) {
+        sql = "SELECT *";
+    } else {
+        sql = "SELECT ";
+        std::string expr;
+        for (Json::ArrayIndex i = 0; i < fields.size(); ++i) {
+            if (!fields[i].isString()) {
+                err = "Field name must be string.";
+                return false;
+            }
+            if (!selectExpr(schemas, table, fields[i].asString(), expr)) {
+                err = "Unknown field: " + fields[i].asString();
+                return false;
+            }
+            sql += expr;
+            if (i != fields.size() - 1) sql += ", ";
+        }
+    }
+    // 游标翻页时在末尾多取两列，用最后一行生成下一页游标，应答前去掉
+    if (keyset) {
+        sql += std::string(", ") + TIME_COLUMN + ", " + ID_COLUMN;
+        out.hiddenColumns = 2;
+    }
+    sql += " FROM " + quoteIdent(table);
+
+    // 游标翻页的排序固定为 received_time，默认降序，同一时间再按 id
+    bool descending = true;
+    if (keyset && request.isMember("sort") && request["sort"].isObject()) {
+        std::string column = request["sort"]["field"].asString();
+        std::string order = request["sort"]["order"].asString();
+        std::transform(order.begin(), order.end(), order.begin(), ::toupper);
+        if (column != TIME_COLUMN || (!order.empty() && order != "ASC" && order != "DESC")) {
+            err = "Cursor pagination sorts by received_time ASC or DESC only";
+            return false;
+        }
+        descending = order != "ASC";
+    }
+
+    std::string start, end;
+    const Json::Value& filter = request["filter"];
+    if (filter.isObject() && filter["time_range"].isObject()) {
+        const Json::Value& timeRange = filter["time_range"];
+        if (timeRange.isMember("start")) start = timeRange["start"].asString();
+        if (timeRange.isMember("end")) end = timeRange["end"].asString();
+        if ((!start.empty() || !end.empty()) && !schemas.hasColumn(table, TIME_COLUMN)) {
+            err = "Unknown field: " + std::string(TIME_COLUMN);
+            return false;
+        }
+    }
+
+    std::vector<std::string> where_clauses;
+    if (keyset) {
+        keysetWhere(descending, start, end, cursorTime, cursorId, where_clauses, out.values);
+    } else if (!start.empty() && !end.empty()) {
+        where_clauses.push_back(std::string(TIME_COLUMN) + " BETWEEN ? AND ?");
+        out.values.push_back(textValue(start));
+        out.values.push_back(textValue(end));
+    } else if (!start.empty()) {
+        where_clauses.push_back(std::string(TIME_COLUMN) + " >= ?");
+        out.values.push_back(textValue(start));
+    } else if (!end.empty()) {
+        where_clauses.push_back(std::string(TIME_COLUMN) + " <= ?");
+        out.values.push_back(textValue(end));
+    }
+
+    if (filter.isObject() && filter["conditions"].isArray()) {
+        for (const auto& cond : filter["conditions"]) {
+            if (!cond.isObject()) {
+                err = "Condition must be object.";
+                return false;
+            }
+            std::string field = cond["field"].asString();
+            const char* op = compareOp(cond["op"].asString());
+            if (!schemas.hasColumn(table, field)) {
+                err = "Unknown field: " + field;
+                return false;
+            }
+            if (!op) {
+                err = "Unsupported operator: " + cond["op"].asString();
+                return false;
+            }
+            // 值按文本绑定，与原来拼成 '...' 字面量时的比较规则(列亲和性转换)相同
+            where_clauses.push_back(quoteIdent(field) + " " + op + " ?");
+            out.values.push_back(textValue(cond["value"].asString()));
+        }
+    }
+
+    if (!where_clauses.empty()) {
+        sql += " WHERE ";
+        for (size_t i = 0; i < where_clauses.size(); ++i) {
+            sql += where_clauses[i];
+            if (i != where_clauses.size() - 1) sql += " AND ";
+        }
+    }
+
+    if (keyset) {
+        sql += std::string(" ORDER BY ") + TIME_COLUMN + (descending ? " DESC, " : " ASC, ") + ID_COLUMN
+             + (descending ? " DESC" : " ASC");
+        int limit = pagination.get("limit", 100).asInt();
+        sql += " LIMIT ?";
+        out.values.push_back(intValue(limit));
+        out.limit = limit;
+        out.sql = sql + ";";
+        return true;
+    }
+
+    if (request.isMember("sort") && request["sort"].isObject()) {
+        std::string column = request["sort"]["field"].asString();
+        std::string order = request["sort"]["order"].asString();
+        std::transform(order.begin(), order.end(), order.begin(), ::toupper);
+        if (!schemas.hasColumn(table, column)) {
+            err = "Unknown sort field: " + column;
+            return false;
+        }
+        if (!order.empty() && order != "ASC" && order != "DESC") {
+            err = "Invalid sort order: " + request["sort"]["order"].asString();
+            return false;
+        }
+        sql += " ORDER BY " + quoteIdent(column);
+        if (!order.empty()) sql += " " + order;
+    }
+
+    if (request.isMember("pagination") && request["pagination"].isObject()) {
+        int offset = request["pagination"].get("offset", 0).asInt();
+        int limit = request["pagination"].get("limit", 100).asInt();
+        sql += " LIMIT ? OFFSET ?";
+        out.values.push_back(intValue(limit));
+        out.values.push_back(intValue(offset));
+    }
+
+    out.sql = sql + ";";
+    return true;
+}
+
+bool compileQuery(const Json::Value& request, const TableSchemas& schemas, CompiledQuery& out, std::string& err) {
+    // 请求里类型不对的值(如字段名为对象、limit 为字符串)由 jsoncpp 抛出异常，按请求错误返回
+    try {
+        return compileRequest(request, schemas, out, err);
+    } catch (const Json::Exception& e) {
+        err = std::string("Invalid request: ") + e.what();
+        return false;
+    }
+}
+
+bool bindQuery(sqlite3_stmt* stmt, const std::vector<QueryValue>& values, std::string& err) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        const QueryValue& v = values[i];
+        int rc = v.isInt ? sqlite3_bind_int64(stmt, int(i) + 1, v.i)
+                         : sqlite3_bind_text(stmt, int(i) + 1, v.text.c_str(), int(v.text.size()), SQLITE_TRANSIENT);
+        if (rc != SQLITE_OK) {
+            err = sqlite3_errmsg(sqlite3_db_handle(stmt));
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+// query_compiler.h
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// 对外字段名：原始帧十六进制(库中为 frame BLOB)、报警文本(查询时由报警位解析)
+extern const char* const FRAME_HEX_FIELD;
+extern const char* const ALARM_TEXT_FIELD;
+
+/*
+ * 库中各表的列名，用于校验请求里的表名和字段名。
+ * 从 sqlite_master 和 PRAGMA table_info 读取，schema_version 不变时不重读。
+ * 不加锁，每个连接一份。
+ */
+class TableSchemas {
+public:
+    bool refresh(sqlite3* db, std::string& err);
+
+    bool hasTable(const std::string& table) const;
+    bool hasColumn(const std::string& table, const std::string& column) const;
+
+private:
+    int version_ = -1;
+    std::map<std::string, std::vector<std::string>> tables_;
+};
+
+// 绑定到 ? 的一个值
+struct QueryValue {
+    bool isInt;
+    int64_t i;
+    std::string text;
+};
+
+// 编译后的查询：值全部以 ? 绑定，同一形状(表、字段、条件列和运算符、排序、是否分页)的请求 SQL 文本相同
+struct CompiledQuery {
+    std::string sql;
+    std::vector<QueryValue> values;
+    size_t hiddenColumns = 0;   // 游标翻页时结果末尾多出的 received_time、id 两列，应答前去掉
+    int limit = -1;             // 游标翻页的每页行数，取满时才有下一页
+};
+
+/*
+ * 把 /api/data/query 请求编译为参数化 SQL：
+ * 表名、字段、条件列和排序列必须在 schemas 中存在(frame_hex、active_alarms、alarm_name 为计算字段)，
+ * 条件运算符限于 = != <> < <= > >= LIKE，排序方向限于 ASC/DESC，
+ * 时间范围、条件值和分页参数都作为绑定值。出错(含值的类型不对)时返回 false 和原因，不抛异常。
+ *
+ * pagination 为 {"limit": n, "cursor": "..."} 时按游标翻页(首页 cursor 为空串)：
+ * 按 (received_time, id) 排序(sort 只能为 received_time，默认降序)，从上一页最后一行之后沿时间索引定位，
+ * 每页代价与页码无关；不带 cursor 时仍为 LIMIT/OFFSET。
+ */
+bool compileQuery(const Json::Value& request, const TableSchemas& schemas, CompiledQuery& out, std::string& err);
+
+// 由一页最后一行的 received_time、id 生成下一页的游标
+std::string encodeCursor(const std::string& time, const std::string& id);
+
+// 按顺序绑定 values，语句需已重置
+bool bindQuery(sqlite3_stmt* stmt, const std::vector<QueryValue>& values, std::string& err);
@@ -0,0 +1,187 @@
+// read_pool.cpp
+#include "read_pool.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include "query_compiler.h"
+
+ReadPool::Lease::Lease(Lease&& other) : pool_(other.pool_), conn_(other.conn_) {
+    other.pool_ = nullptr;
+    other.conn_ = nullptr;
+}
+
+ReadPool::Lease& ReadPool::Lease::operator=(Lease&& other) {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        conn_ = other.conn_;
+        other.pool_ = nullptr;
+        other.conn_ = nullptr;
+    }
+    return *this;
+}
+
+ReadPool::Lease::~Lease() {
+    release();
+}
+
+void ReadPool::Lease::release() {
+    if (conn_) pool_->release(conn_);
+    pool_ = nullptr;
+    conn_ = nullptr;
+}
+
+sqlite3* ReadPool::Lease::db() const {
+    return conn_ ? conn_->db : nullptr;
+}
+
+TableSchemas& ReadPool::Lease::schemas() {
+    return *conn_->schemas;
+}
+
+sqlite3_stmt* ReadPool::Lease::prepare(const std::string& sql, std::string& err) {
+    if (!conn_) {
+        err = "No connection";
+        return nullptr;
+    }
+    return pool_->prepare(*conn_, sql, err);
+}
+
+ReadPool::ReadPool(const std::string& dbPath, size_t size, OpenHook onOpen, size_t statementCache)
+    : dbPath_(dbPath), size_(size ? size : 1), onOpen_(onOpen), statementCache_(statementCache ? statementCache : 1) {
+}
+
+// 所有 Lease 需已归还
+ReadPool::~ReadPool() {
+    for (const std::unique_ptr<Connection>& conn : connections_) {
+        for (auto& entry : conn->statements) sqlite3_finalize(entry.second.stmt);
+        sqlite3_close(conn->db);
+    }
+}
+
+ReadPool::Lease ReadPool::acquire(int timeoutMs, std::string& err) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::milliseconds(timeoutMs);
+    bool waited = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    Connection* conn = nullptr;
+    while (!conn) {
+        if (!idle_.empty()) {
+            conn = idle_.back();
+            idle_.pop_back();
+        } else if (connections_.size() + opening_ < size_) {
+            // 池未满时打开新连接，打开期间不持锁
+            ++opening_;
+            lock.unlock();
+            conn = open(err);
+            lock.lock();
+            --opening_;
+            if (!conn) {
+                // 让等待的线程自己再试
+                available_.notify_one();
+                return Lease();
+            }
+            connections_.push_back(std::unique_ptr<Connection>(conn));
+        } else {
+            waited = true;
+            if (available_.wait_until(lock, deadline) == std::cv_status::timeout && idle_.empty()) {
+                ++timeouts_;
+                err = "Database busy";
+                return Lease();
+            }
+        }
+    }
+
+    ++leases_;
+    if (waited) {
+        uint64_t ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        ++waited_;
+        waitNs_ += ns;
+        waitMaxNs_ = std::max(waitMaxNs_, ns);
+    }
+    return Lease(this, conn);
+}
+
+ReadPool::Connection* ReadPool::open(std::string& err) {
+    sqlite3* db = nullptr;
+    // 每个连接同一时刻只在一个线程使用，不需要 SQLite 的连接级互斥
+    if (sqlite3_open_v2(dbPath_.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        err = db ? sqlite3_errmsg(db) : "Out of memory";
+        sqlite3_close(db);
+        return nullptr;
+    }
+    // 写库线程做检查点时可能短暂持锁
+    sqlite3_busy_timeout(db, 1000);
+    if (onOpen_) onOpen_(db);
+
+    Connection* conn = new Connection();
+    conn->db = db;
+    conn->clock = 0;
+    conn->schemas.reset(new TableSchemas());
+    return conn;
+}
+
+void ReadPool::release(Connection* conn) {
+    // 结束语句的读事务，否则会一直挡住 WAL 检查点
+    for (sqlite3_stmt* stmt : conn->used) sqlite3_reset(stmt);
+    conn->used.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(conn);
+    }
+    available_.notify_one();
+}
+
+sqlite3_stmt* ReadPool::prepare(Connection& conn, const std::string& sql, std::string& err) {
+    ++conn.clock;
+    sqlite3_stmt* stmt = nullptr;
+    std::unordered_map<std::string, Statement>::iterator it = conn.statements.find(sql);
+    if (it != conn.statements.end()) {
+        ++stmtHits_;
+        stmt = it->second.stmt;
+        it->second.lastUse = conn.clock;
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    } else {
+        ++stmtMisses_;
+        if (sqlite3_prepare_v2(conn.db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            err = sqlite3_errmsg(conn.db);
+            sqlite3_finalize(stmt);
+            return nullptr;
+        }
+        // 缓存满时淘汰最久没用的语句，本次借出期间用过的不淘汰
+        if (conn.statements.size() >= statementCache_) {
+            std::unordered_map<std::string, Statement>::iterator oldest = conn.statements.end();
+            for (it = conn.statements.begin(); it != conn.statements.end(); ++it) {
+                if (std::find(conn.used.begin(), conn.used.end(), it->second.stmt) != conn.used.end()) continue;
+                if (oldest == conn.statements.end() || it->second.lastUse < oldest->second.lastUse) oldest = it;
+            }
+            if (oldest != conn.statements.end()) {
+                sqlite3_finalize(oldest->second.stmt);
+                conn.statements.erase(oldest);
+            }
+        }
+        Statement entry;
+        entry.stmt = stmt;
+        entry.lastUse = conn.clock;
+        conn.statements[sql] = entry;
+    }
+    if (std::find(conn.used.begin(), conn.used.end(), stmt) == conn.used.end()) conn.used.push_back(stmt);
+    return stmt;
+}
+
+ReadPool::Stats ReadPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats st;
+    st.leases = leases_;
+    st.waited = waited_;
+    st.timeouts = timeouts_;
+    st.waitAvgUs = waited_ ? double(waitNs_) / waited_ / 1e3 : 0.0;
+    st.waitMaxUs = double(waitMaxNs_) / 1e3;
+    st.open = uint32_t(connections_.size());
+    st.stmtHits = stmtHits_.load();
+    st.stmtMisses = stmtMisses_.load();
+    return st;
+}
@@ -0,0 +1,116 @@
+// read_pool.h
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+class TableSchemas;
+
+/*
+ * 历史查询用的只读连接池：最多 size 个长期打开的只读连接(库为 WAL 模式，读不阻塞写库线程)，
+ * 第一次需要时才打开，之后一直复用，不再每个请求重新读 schema 和 WAL 索引。
+ * 每个连接缓存最近用过的预编译语句，以 SQL 文本为键(值都用 ? 绑定时即为查询形状)，以及库的表结构。
+ * 请求线程借出一个连接，用完自动归还；连接全部借出时等待，等待次数和时长计入统计。
+ */
+class ReadPool {
+public:
+    // 连接池统计
+    struct Stats {
+        uint64_t leases;        // 成功借出次数
+        uint64_t waited;        // 需要等待的次数
+        uint64_t timeouts;      // 等待超时次数
+        double   waitAvgUs;     // 等待过的借出的平均等待时间
+        double   waitMaxUs;
+        uint32_t open;          // 已打开的连接数
+        uint64_t stmtHits;      // 语句缓存命中
+        uint64_t stmtMisses;
+    };
+
+    // 新连接打开后调用，用于注册自定义 SQL 函数等
+    typedef std::function<void(sqlite3*)> OpenHook;
+
+private:
+    struct Connection;
+
+public:
+    // 借出的连接，析构时归还；归还前重置本次用过的语句，不留读事务
+    class Lease {
+    public:
+        Lease() : pool_(nullptr), conn_(nullptr) {}
+        Lease(Lease&& other);
+        Lease& operator=(Lease&& other);
+        ~Lease();
+
+        explicit operator bool() const { return conn_ != nullptr; }
+        sqlite3* db() const;
+
+        // 取缓存的预编译语句，没有时编译并缓存；返回的语句已重置、绑定已清空，不要 finalize
+        sqlite3_stmt* prepare(const std::string& sql, std::string& err);
+
+        // 本连接缓存的表结构，使用前调用 refresh()
+        TableSchemas& schemas();
+
+    private:
+        friend class ReadPool;
+        Lease(ReadPool* pool, Connection* conn) : pool_(pool), conn_(conn) {}
+        Lease(const Lease&);
+        Lease& operator=(const Lease&);
+        void release();
+
+        ReadPool* pool_;
+        Connection* conn_;
+    };
+
+    ReadPool(const std::string& dbPath, size_t size, OpenHook onOpen = OpenHook(), size_t statementCache = 32);
+    ~ReadPool();
+
+    // 借出一个连接，最多等 timeoutMs 毫秒；打开失败或超时返回空 Lease，原因写入 err
+    Lease acquire(int timeoutMs, std::string& err);
+
+    Stats stats() const;
+
+private:
+    struct Statement {
+        sqlite3_stmt* stmt;
+        uint64_t lastUse;
+    };
+    struct Connection {
+        sqlite3* db;
+        std::unordered_map<std::string, Statement> statements;
+        std::vector<sqlite3_stmt*> used;    // 本次借出期间用过的语句
+        uint64_t clock;
+        std::unique_ptr<TableSchemas> schemas;
+    };
+
+    std::string dbPath_;
+    size_t size_;
+    OpenHook onOpen_;
+    size_t statementCache_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::vector<Connection*> idle_;
+    size_t opening_ = 0;        // 正在打开(未加锁)的连接数
+
+    uint64_t leases_ = 0;
+    uint64_t waited_ = 0;
+    uint64_t timeouts_ = 0;
+    uint64_t waitNs_ = 0;
+    uint64_t waitMaxNs_ = 0;
+    std::atomic<uint64_t> stmtHits_{0};     // 语句缓存在借出的连接上使用，不持锁
+    std::atomic<uint64_t> stmtMisses_{0};
+
+    Connection* open(std::string& err);
+    void release(Connection* conn);
+    sqlite3_stmt* prepare(Connection& conn, const std::string& sql, std::string& err);
+};
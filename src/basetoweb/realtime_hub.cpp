@@ -0,0 +1,34 @@
+// realtime_hub.cpp
+#include "realtime_hub.h"
+
+RealtimeHub::RealtimeHub(const LatestStore& store, size_t historySize)
+    : store_(store), history_(historySize), count_(0) {
+}
+
+int RealtimeHub::subscribe(Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry;
+    entry.id = nextId_++;
+    entry.callback = std::move(callback);
+    entries_.push_back(std::move(entry));
+    count_.store(int(entries_.size()), std::memory_order_release);
+    return entries_.back().id;
+}
+
+void RealtimeHub::unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].id == id) {
+            entries_.erase(entries_.begin() + i);
+            break;
+        }
+    }
+    count_.store(int(entries_.size()), std::memory_order_release);
+}
+
+void RealtimeHub::publish(const DecodedFrame& frame) {
+    history_.push(frame);
+    if (count_.load(std::memory_order_acquire) == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Entry& entry : entries_) entry.callback(frame.frame);
+}
@@ -0,0 +1,45 @@
+// realtime_hub.h
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "latest_store.h"
+#include "frame_history.h"
+
+/*
+ * 新帧发布：采集线程每更新一次 LatestStore 后调用一次 publish(frame)，
+ * 帧追加到最近帧历史(流式接口断线续传用)，再依次调用已登记的回调(推送通道用它唤醒各自的发送)。
+ * 回调在采集线程中执行且持有内部锁，只能做置标志、投递任务这类很快的事，
+ * 不能在回调里调用 subscribe/unsubscribe。没有订阅者时只多一次历史追加。
+ */
+class RealtimeHub {
+public:
+    typedef std::function<void(int frame)> Callback;
+
+    // store 需在本对象存续期间有效；historySize 为保留的最近帧数(每帧约 0.8KB)
+    RealtimeHub(const LatestStore& store, size_t historySize = 1024);
+
+    const LatestStore& store() const { return store_; }
+    const FrameHistory& history() const { return history_; }
+
+    // 返回订阅编号，用于 unsubscribe
+    int subscribe(Callback callback);
+    void unsubscribe(int id);
+
+    void publish(const DecodedFrame& frame);
+
+private:
+    struct Entry {
+        int id;
+        Callback callback;
+    };
+
+    const LatestStore& store_;
+    FrameHistory history_;
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+    int nextId_ = 1;
+    std::atomic<int> count_;
+};
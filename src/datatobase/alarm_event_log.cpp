@@ -0,0 +1,98 @@
+// alarm_event_log.cpp
+#include "alarm_event_log.h"
+#include <iostream>
+
+AlarmEventLog::AlarmEventLog(const std::string& source) : source_(source) {
+    last_.lo = 0;
+    last_.hi = 0;
+}
+
+AlarmEventLog::~AlarmEventLog() {
+    sqlite3_finalize(insertStmt_);
+}
+
+bool AlarmEventLog::init(sqlite3* db) {
+    db_ = db;
+    const char* createSQL = R"(
+        CREATE TABLE IF NOT EXISTS alarm_events (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            source TEXT NOT NULL,                      -- 来源数据表，如 'lop1_frame1'
+            bit INTEGER NOT NULL,                      -- 报警位编号，文本在查询时解析
+            edge INTEGER NOT NULL,                     -- 1: 报警出现，0: 报警消失
+            frame_id INTEGER,                          -- 触发该边沿的帧在 source 表中的 id
+            event_time DATETIME NOT NULL,              -- 帧接收时间(本地时间，毫秒)
+            rx_time_ns INTEGER                         -- 帧接收时间 CLOCK_REALTIME 纳秒
+        );
+    )";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db_, createSQL, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "Table alarm_events creation failed: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    sqlite3_exec(db_, "CREATE INDEX IF NOT EXISTS idx_alarm_events_bit ON alarm_events(source, bit, event_time DESC);",
+                 nullptr, nullptr, nullptr);
+    sqlite3_exec(db_, "CREATE INDEX IF NOT EXISTS idx_alarm_events_time ON alarm_events(event_time DESC);",
+                 nullptr, nullptr, nullptr);
+
+    sqlite3_finalize(insertStmt_);
+    insertStmt_ = nullptr;
+    if (sqlite3_prepare_v2(db_, R"(
+        INSERT INTO alarm_events (source, bit, edge, frame_id, event_time, rx_time_ns)
+        VALUES (?, ?, ?, ?, ?, ?);
+    )", -1, &insertStmt_, nullptr) != SQLITE_OK) {
+        std::cerr << "Prepare alarm_events insert failed: " << sqlite3_errmsg(db_) << std::endl;
+        return false;
+    }
+
+    // 重启后接着上次的状态比较，避免把仍然存在的报警重复记成新边沿
+    std::string sql = "SELECT alarm_bits, alarm_bits_hi FROM " + source_
+                    + " WHERE alarm_bits IS NOT NULL ORDER BY id DESC LIMIT 1;";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        sql = "SELECT alarm_bits, 0 FROM " + source_
+            + " WHERE alarm_bits IS NOT NULL ORDER BY id DESC LIMIT 1;";
+        sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    }
+    if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
+        last_.lo = uint64_t(sqlite3_column_int64(stmt, 0));
+        last_.hi = uint64_t(sqlite3_column_int64(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+void AlarmEventLog::writeEdges(uint64_t changed, uint64_t now, int bitBase,
+                               long frameId, const std::string& eventTime, int64_t rxTimeNs, int& count) {
+    while (changed) {
+        int bit = __builtin_ctzll(changed);
+        changed &= changed - 1;
+
+        sqlite3_bind_text(insertStmt_, 1, source_.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(insertStmt_, 2, bitBase + bit);
+        sqlite3_bind_int(insertStmt_, 3, int((now >> bit) & 1));
+        sqlite3_bind_int64(insertStmt_, 4, frameId);
+        sqlite3_bind_text(insertStmt_, 5, eventTime.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(insertStmt_, 6, rxTimeNs);
+        if (sqlite3_step(insertStmt_) != SQLITE_DONE) {
+            std::cerr << "插入 alarm_events 失败: " << sqlite3_errmsg(db_) << std::endl;
+        } else {
+            ++count;
+        }
+        sqlite3_reset(insertStmt_);
+        sqlite3_clear_bindings(insertStmt_);
+    }
+}
+
+int AlarmEventLog::record(const AlarmBits& bits, long frameId, const std::string& eventTime, int64_t rxTimeNs) {
+    if (!insertStmt_) return 0;
+
+    AlarmBits changed = bits ^ last_;
+    last_ = bits;
+    if (!changed.any()) return 0;
+
+    int count = 0;
+    writeEdges(changed.lo, bits.lo, 0, frameId, eventTime, rxTimeNs, count);
+    writeEdges(changed.hi, bits.hi, 64, frameId, eventTime, rxTimeNs, count);
+    return count;
+}
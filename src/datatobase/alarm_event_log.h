@@ -0,0 +1,33 @@
+// alarm_event_log.h
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <sqlite3.h>
+#include "alarm_bits.h"
+
+/*
+ * 报警边沿记录：每个数据表(source)保存上一帧的报警位，
+ * 新帧到来时只把发生变化的位写入 alarm_events(edge=1 出现，edge=0 消失)。
+ * 报警文本不入库，查询时按 source + bit 从解析器的报警表解析。
+ */
+class AlarmEventLog {
+public:
+    explicit AlarmEventLog(const std::string& source);
+    ~AlarmEventLog();
+
+    // 建 alarm_events 表并编译插入语句；上一状态取自 source 表最后一行的 alarm_bits
+    bool init(sqlite3* db);
+
+    // 与上一帧比较并写入边沿，返回写入的事件数
+    int record(const AlarmBits& bits, long frameId, const std::string& eventTime, int64_t rxTimeNs);
+
+private:
+    std::string source_;
+    sqlite3* db_ = nullptr;
+    sqlite3_stmt* insertStmt_ = nullptr;
+    AlarmBits last_;
+
+    void writeEdges(uint64_t changed, uint64_t now, int bitBase,
+                    long frameId, const std::string& eventTime, int64_t rxTimeNs, int& count);
+};
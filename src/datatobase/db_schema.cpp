@@ -0,0 +1,145 @@
+// db_schema.cpp
+#include "db_schema.h"
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <ctime>
+
+bool dbHasColumn(sqlite3* db, const char* table, const char* column) {
+    std::string sql = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
+    bool found = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (name && std::string(name) == column) {
+            found = true;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+void dbEnsureColumn(sqlite3* db, const char* table, const char* column, const char* type) {
+    if (dbHasColumn(db, table, column)) return;
+
+    std::string sql = std::string("ALTER TABLE ") + table + " ADD COLUMN " + column + " " + type + ";";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "Add column " << column << " failed: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+    }
+}
+
+std::vector<std::string> dbIndexesOn(sqlite3* db, const char* table, const char* column) {
+    std::vector<std::string> names;
+    std::string sql = std::string("PRAGMA index_list(") + table + ");";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return names;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        names.push_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+    }
+    sqlite3_finalize(stmt);
+
+    std::vector<std::string> found;
+    for (const std::string& name : names) {
+        sql = "PRAGMA index_info(\"" + name + "\");";
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) continue;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* col = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+            if (sqlite3_column_int(stmt, 0) == 0 && col && std::string(col) == column) found.push_back(name);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return found;
+}
+
+std::string dbFormatRxTime(int64_t realNs) {
+    time_t sec = time_t(realNs / 1000000000LL);
+    int ms = int((realNs / 1000000LL) % 1000);
+    struct tm tmv;
+    localtime_r(&sec, &tmv);
+    char buf[32];
+    size_t n = strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tmv);
+    snprintf(buf + n, sizeof(buf) - n, ".%03d", ms);
+    return buf;
+}
+
+static int hexNibble(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// SQL 函数 frame_unhex(text)：十六进制文本转 BLOB，非法输入返回 NULL
+static void sqlFrameUnhex(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    const unsigned char* hex = sqlite3_value_text(argv[0]);
+    int len = sqlite3_value_bytes(argv[0]);
+    if (!hex || len % 2) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    std::vector<uint8_t> out(len / 2);
+    for (int i = 0; i < len / 2; ++i) {
+        int hi = hexNibble(hex[2 * i]);
+        int lo = hexNibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+        out[i] = uint8_t(hi << 4 | lo);
+    }
+    sqlite3_result_blob(ctx, out.data(), int(out.size()), SQLITE_TRANSIENT);
+}
+
+bool dbMigrateHexFrame(sqlite3* db, const char* table, const char* createSQL) {
+    if (!dbHasColumn(db, table, "frame_hex")) return true;
+
+    std::cout << "Migrating " << table << ".frame_hex to BLOB..." << std::endl;
+    sqlite3_create_function(db, "frame_unhex", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                            nullptr, sqlFrameUnhex, nullptr, nullptr);
+
+    std::string oldTable = std::string(table) + "_hex_old";
+
+    // 除 frame_hex 外的列原样拷贝
+    std::string columns;
+    std::string sql = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (name == "frame_hex") continue;
+        columns += name + ", ";
+    }
+    sqlite3_finalize(stmt);
+
+    // 原始帧无法还原的行不丢弃，解码列仍然有效
+    sql = std::string("SELECT COUNT(*) FROM ") + table + " WHERE frame_unhex(frame_hex) IS NULL;";
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        sqlite3_int64 bad = sqlite3_column_int64(stmt, 0);
+        if (bad) std::cerr << table << ": " << bad << " rows with empty or invalid frame_hex kept with empty frame" << std::endl;
+    }
+    sqlite3_finalize(stmt);
+
+    std::string steps[] = {
+        "BEGIN IMMEDIATE;",
+        std::string("ALTER TABLE ") + table + " RENAME TO " + oldTable + ";",
+        createSQL,
+        std::string("INSERT INTO ") + table + " (" + columns + "frame) SELECT " + columns
+            + "COALESCE(frame_unhex(frame_hex), X'') FROM " + oldTable + ";",
+        std::string("DROP TABLE ") + oldTable + ";",
+        "COMMIT;"
+    };
+    for (const auto& step : steps) {
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db, step.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            std::cerr << "Migrate " << table << " failed: " << (errMsg ? errMsg : "") << std::endl;
+            sqlite3_free(errMsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+// db_schema.h
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+/*
+ * LOP1/LOP2 数据库共用的建表、迁移辅助函数
+ */
+
+// 表中是否存在某列
+bool dbHasColumn(sqlite3* db, const char* table, const char* column);
+
+// 旧库缺少的列用 ALTER TABLE 补上
+void dbEnsureColumn(sqlite3* db, const char* table, const char* column, const char* type);
+
+// 表上以 column 为第一列的索引名(按 PRAGMA index_list 顺序)
+std::vector<std::string> dbIndexesOn(sqlite3* db, const char* table, const char* column);
+
+// 本地时间 "YYYY-MM-DD HH:MM:SS.mmm"，与 received_time 原有格式兼容
+std::string dbFormatRxTime(int64_t realNs);
+
+/*
+ * 旧表以 frame_hex TEXT 存原始帧，新表为 frame BLOB。
+ * 旧表存在时：改名 -> 用 createSQL 建新表 -> 逐行把十六进制转回二进制拷入 -> 删除旧表，
+ * 整个过程在一个事务中完成。十六进制为空或无法解析的行照样保留(frame 为空 BLOB，解码列不变)，
+ * 行数打印到日志。返回 false 表示迁移失败(旧表保持原样)。
+ */
+bool dbMigrateHexFrame(sqlite3* db, const char* table, const char* createSQL);
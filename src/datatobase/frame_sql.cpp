@@ -0,0 +1,32 @@
+// frame_sql.cpp
+#include "frame_sql.h"
+
+std::string frameColumnsDDL(const std::vector<FrameColumn>& columns)
+{
+    std::string ddl;
+    for (const FrameColumn& c : columns) {
+        ddl += std::string("            ") + c.column + " " + c.sqlType + ",  -- " + c.label;
+        if (c.unit[0]) ddl += std::string(" (单位：") + c.unit + ")";
+        ddl += "\n";
+    }
+    return ddl;
+}
+
+std::string frameColumnList(const std::vector<FrameColumn>& columns)
+{
+    std::string list;
+    for (const FrameColumn& c : columns) list += std::string(", ") + c.column;
+    return list;
+}
+
+std::string framePlaceholders(const std::vector<FrameColumn>& columns)
+{
+    std::string list;
+    for (size_t i = 0; i < columns.size(); ++i) list += ", ?";
+    return list;
+}
+
+void ensureFrameColumns(sqlite3* db, const char* table, const std::vector<FrameColumn>& columns)
+{
+    for (const FrameColumn& c : columns) dbEnsureColumn(db, table, c.column, c.sqlType);
+}
@@ -0,0 +1,78 @@
+// frame_sql.h
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+#include "frame_fields.h"
+#include "db_schema.h"
+
+/*
+ * 由帧字段描述表生成建表列、插入列和参数绑定，
+ * 与解析器共用同一张表，列名/类型/顺序不会与解码不一致。
+ * 编译期的 FieldDesc 表和运行时读入的设备描述文件都先转成 FrameColumn 列表，共用同一套生成函数。
+ */
+
+// 一个字段列，指针只需在调用期间有效
+struct FrameColumn
+{
+    const char* column;
+    const char* sqlType;    // INTEGER 或 REAL
+    const char* label;
+    const char* unit;       // 无单位时为空串
+};
+
+// 建表语句中的字段列，每列一行，末尾带逗号
+std::string frameColumnsDDL(const std::vector<FrameColumn>& columns);
+// INSERT 列名列表，每列前带 ", "
+std::string frameColumnList(const std::vector<FrameColumn>& columns);
+// 与 frameColumnList 对应的占位符
+std::string framePlaceholders(const std::vector<FrameColumn>& columns);
+// 表中缺少的字段列补上(描述新增字段后旧库自动加列)
+void ensureFrameColumns(sqlite3* db, const char* table, const std::vector<FrameColumn>& columns);
+
+template <typename Data, size_t N>
+std::vector<FrameColumn> frameColumns(const FieldDesc<Data> (&fields)[N])
+{
+    std::vector<FrameColumn> columns;
+    for (size_t i = 0; i < N; ++i) {
+        FrameColumn c = {fields[i].column, fields[i].sqlType(), fields[i].label, fields[i].unit};
+        columns.push_back(c);
+    }
+    return columns;
+}
+
+template <typename Data, size_t N>
+std::string frameColumnsDDL(const FieldDesc<Data> (&fields)[N])
+{
+    return frameColumnsDDL(frameColumns(fields));
+}
+
+template <typename Data, size_t N>
+std::string frameColumnList(const FieldDesc<Data> (&fields)[N])
+{
+    return frameColumnList(frameColumns(fields));
+}
+
+template <typename Data, size_t N>
+std::string framePlaceholders(const FieldDesc<Data> (&fields)[N])
+{
+    return framePlaceholders(frameColumns(fields));
+}
+
+template <typename Data, size_t N>
+void ensureFrameColumns(sqlite3* db, const char* table, const FieldDesc<Data> (&fields)[N])
+{
+    ensureFrameColumns(db, table, frameColumns(fields));
+}
+
+// 从第 first 个参数开始依次绑定字段值，返回下一个参数序号
+template <typename Data, size_t N>
+int bindFrameFields(sqlite3_stmt* stmt, int first, const FieldDesc<Data> (&fields)[N], const Data& data)
+{
+    for (size_t i = 0; i < N; ++i) {
+        if (fields[i].isInteger()) sqlite3_bind_int(stmt, first++, data.*(fields[i].u16));
+        else                       sqlite3_bind_double(stmt, first++, data.*(fields[i].f32));
+    }
+    return first;
+}
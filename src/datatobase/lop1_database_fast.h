@@ -8,6 +8,9 @@
 #include <sstream>
 #include <string>
 #include <sqlite3.h>
+#include "db_schema.h"
+#include "frame_sql.h"
+#include "alarm_event_log.h"
 #include "lop1_frame1.h"
 #include "lop1_frame2.h"
 
@@ -30,5 +33,10 @@ private:
     sqlite3* db_ = nullptr;
     std::string dbPath_;
 
-    std::string toHex(const uint8_t* buffer, size_t len);
+    // 插入语句在 frameN_init() 中编译一次，之后每行只 reset + 重新绑定
+    sqlite3_stmt* frame1Stmt_ = nullptr;
+    sqlite3_stmt* frame2Stmt_ = nullptr;
+
+    AlarmEventLog alarmEvents1_;
+    AlarmEventLog alarmEvents2_;
 };
@@ -8,6 +8,9 @@
 #include <sstream>
 #include <string>
 #include <sqlite3.h>
+#include "db_schema.h"
+#include "frame_sql.h"
+#include "alarm_event_log.h"
 #include "lop2_frame.h"
 
 
@@ -26,5 +29,8 @@ private:
     sqlite3* db_ = nullptr;
     std::string dbPath_;
 
-    std::string toHex(const uint8_t* buffer, size_t len);
+    // 插入语句在 frame_init() 中编译一次，之后每行只 reset + 重新绑定
+    sqlite3_stmt* frameStmt_ = nullptr;
+
+    AlarmEventLog alarmEvents_;
 };
@@ -0,0 +1,155 @@
+// profile_database.cpp
+#include "profile_database.h"
+#include <algorithm>
+#include <iostream>
+#include "frame_sql.h"
+
+ProfileDatabase::ProfileDatabase(const std::string& dbPath)
+    : dbPath_(dbPath) {
+    if (sqlite3_open(dbPath_.c_str(), &db_) != SQLITE_OK) {
+        std::cerr << "SQLite open failed: " << sqlite3_errmsg(db_) << std::endl;
+    } else {
+        sqlite3_exec(db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+        sqlite3_busy_timeout(db_, 1000);
+    }
+}
+
+ProfileDatabase::~ProfileDatabase() {
+    for (Table& table : tables_) sqlite3_finalize(table.stmt);
+    tables_.clear();
+    if (db_) sqlite3_close(db_);
+}
+
+// SQL 字符串字面量中的单引号加倍
+static std::string sqlQuote(const std::string& text) {
+    std::string out = "'";
+    for (char c : text) {
+        if (c == '\'') out += '\'';
+        out += c;
+    }
+    return out + "'";
+}
+
+bool ProfileDatabase::initTable(const FrameSpec& spec, Table& table) {
+    table.spec = &spec;
+    table.hasHi = spec.alarmBytes > 8;
+    table.stmt = nullptr;
+    const char* name = spec.table.c_str();
+
+    std::vector<FrameColumn> fields;
+    for (const FieldSpec& field : spec.fields) {
+        FrameColumn c = {field.column.c_str(), field.real ? "REAL" : "INTEGER", field.label.c_str(), field.unit.c_str()};
+        fields.push_back(c);
+    }
+
+    std::string createSQL = "\n        CREATE TABLE IF NOT EXISTS " + spec.table + " (\n"
+        "            id INTEGER PRIMARY KEY AUTOINCREMENT,\n"
+        "            device_id TEXT DEFAULT " + sqlQuote(spec.deviceId) + ",\n"
+        "            frame BLOB NOT NULL,                        -- 原始帧(二进制)，十六进制仅在查询时生成\n"
+        + frameColumnsDDL(fields);
+    createSQL += "            active_alarms TEXT,                        -- 旧版报警文本(JSON)，新数据不再写入\n"
+                 "            alarm_bits INTEGER,                        -- 报警字节区原始位(Bit 0~63)\n";
+    if (table.hasHi) {
+        createSQL += "            alarm_bits_hi INTEGER,                     -- 报警字节区原始位(Bit 64~127)\n";
+    }
+    createSQL += "            received_time DATETIME DEFAULT (datetime('now','localtime')), -- 原始数据接收时间(串口读到帧的时刻)\n"
+                 "            rx_time_ns INTEGER,                        -- 接收时间 CLOCK_REALTIME 纳秒\n"
+                 "            rx_mono_ns INTEGER                         -- 接收时间 CLOCK_MONOTONIC 纳秒，用于多端口对时\n"
+                 "        );\n    ";
+
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db_, createSQL.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "Table " << spec.table << " creation failed: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    // 描述文件新增字段时旧表补列
+    ensureFrameColumns(db_, name, fields);
+    dbEnsureColumn(db_, name, "rx_time_ns", "INTEGER");
+    dbEnsureColumn(db_, name, "rx_mono_ns", "INTEGER");
+    dbEnsureColumn(db_, name, "alarm_bits", "INTEGER");
+    if (table.hasHi) dbEnsureColumn(db_, name, "alarm_bits_hi", "INTEGER");
+    // 旧库 frame_hex 文本列迁移为 frame BLOB
+    dbMigrateHexFrame(db_, name, createSQL.c_str());
+    // 沿用旧表时已有 LOP1Database/LOP2Database 建的时间索引(idx_frame1_time 等)，不再重复建一个，
+    // 否则每次插入要维护两份相同的索引；之前版本已重复建出的本索引删掉。
+    // 新建的索引带上 id，游标翻页和分段导出按 (received_time, id) 排序时直接沿索引读，同一时间的行不用再排序
+    std::string timeIndex = "idx_" + spec.table + "_time";
+    std::vector<std::string> indexes = dbIndexesOn(db_, name, "received_time");
+    std::string indexSQL;
+    if (indexes.empty()) {
+        indexSQL = "CREATE INDEX IF NOT EXISTS " + timeIndex + " ON " + spec.table + "(received_time DESC, id DESC);";
+    } else if (indexes.size() > 1 && std::find(indexes.begin(), indexes.end(), timeIndex) != indexes.end()) {
+        indexSQL = "DROP INDEX " + timeIndex + ";";
+    }
+    if (!indexSQL.empty()) sqlite3_exec(db_, indexSQL.c_str(), nullptr, nullptr, nullptr);
+
+    std::string insertSQL = "INSERT INTO " + spec.table + " (device_id, frame" + frameColumnList(fields)
+        + (table.hasHi ? ", alarm_bits, alarm_bits_hi" : ", alarm_bits") + ", received_time, rx_time_ns, rx_mono_ns) VALUES (?, ?"
+        + framePlaceholders(fields) + (table.hasHi ? ", ?, ?" : ", ?") + ", ?, ?, ?);";
+    if (sqlite3_prepare_v2(db_, insertSQL.c_str(), -1, &table.stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Prepare " << spec.table << " insert failed: " << sqlite3_errmsg(db_) << std::endl;
+        return false;
+    }
+
+    table.alarmEvents.reset(new AlarmEventLog(spec.table));
+    return table.alarmEvents->init(db_);
+}
+
+bool ProfileDatabase::init(const DeviceProfile& profile) {
+    for (Table& table : tables_) sqlite3_finalize(table.stmt);
+    tables_.clear();
+    tables_.resize(profile.frames.size());
+    bool ok = db_ != nullptr;
+    for (size_t i = 0; ok && i < profile.frames.size(); ++i) {
+        ok = initTable(profile.frames[i], tables_[i]);
+    }
+    return ok;
+}
+
+long ProfileDatabase::insert(const DecodedFrame& frame) {
+    if (frame.frame < 0 || frame.frame >= int(tables_.size()) || !tables_[frame.frame].stmt) {
+        std::cerr << "帧 " << frame.frame << " 的插入语句未准备，请先调用 init()" << std::endl;
+        return -1;
+    }
+    Table& table = tables_[frame.frame];
+    const FrameSpec& spec = *table.spec;
+    sqlite3_stmt* stmt = table.stmt;
+
+    int idx = 1;
+    sqlite3_bind_text(stmt, idx++, spec.deviceId.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, idx++, frame.raw, frame.len, SQLITE_STATIC);
+    for (int i = 0; i < frame.fieldCount; ++i) {
+        if (spec.fields[i].real) sqlite3_bind_double(stmt, idx++, frame.values[i]);
+        else                     sqlite3_bind_int64(stmt, idx++, int64_t(frame.values[i]));
+    }
+    sqlite3_bind_int64(stmt, idx++, int64_t(frame.alarmBits.lo));
+    if (table.hasHi) sqlite3_bind_int64(stmt, idx++, int64_t(frame.alarmBits.hi));
+    std::string rxTime = dbFormatRxTime(frame.rx.realNs);
+    sqlite3_bind_text(stmt, idx++, rxTime.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, idx++, frame.rx.realNs);
+    sqlite3_bind_int64(stmt, idx++, frame.rx.monoNs);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        std::cerr << "插入 " << spec.table << " 失败: " << sqlite3_errmsg(db_) << std::endl;
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return -1;
+    }
+
+    long rowId = sqlite3_last_insert_rowid(db_);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    // 报警位有变化时记录边沿
+    table.alarmEvents->record(frame.alarmBits, rowId, rxTime, frame.rx.realNs);
+    return rowId;
+}
+
+void ProfileDatabase::beginTransaction() {
+    sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+}
+
+void ProfileDatabase::commitTransaction() {
+    sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr);
+}
@@ -0,0 +1,45 @@
+// profile_database.h
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+#include "db_schema.h"
+#include "alarm_event_log.h"
+#include "device_profile.h"
+#include "decode_program.h"
+
+/*
+ * 按设备描述文件建表和入库：每种帧一张表，列布局与 LOP1Database/LOP2Database 相同
+ * (id, device_id, frame BLOB, 字段列..., alarm_bits[, alarm_bits_hi], received_time, rx_time_ns, rx_mono_ns)，
+ * 描述文件沿用已有表名时直接写入原表，网页查询不受影响。
+ */
+class ProfileDatabase {
+public:
+    explicit ProfileDatabase(const std::string& dbPath);
+    ~ProfileDatabase();
+
+    // 建表(旧表补列)并为每种帧编译一次插入语句；profile 需在本对象存续期间有效
+    bool init(const DeviceProfile& profile);
+
+    // 写入一帧，返回行 id，失败返回 -1
+    long insert(const DecodedFrame& frame);
+
+    void beginTransaction();
+    void commitTransaction();
+
+private:
+    struct Table {
+        const FrameSpec* spec;
+        bool hasHi;                         // 报警位超过 64 个时多一列 alarm_bits_hi
+        sqlite3_stmt* stmt;
+        std::unique_ptr<AlarmEventLog> alarmEvents;
+    };
+
+    sqlite3* db_ = nullptr;
+    std::string dbPath_;
+    std::vector<Table> tables_;             // 与 profile.frames 下标一致
+
+    bool initTable(const FrameSpec& spec, Table& table);
+};
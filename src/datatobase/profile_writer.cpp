@@ -0,0 +1,68 @@
+// profile_writer.cpp
+#include "profile_writer.h"
+
+ProfileWriter::ProfileWriter(ProfileDatabase& db) : db_(db), written_(0), dropped_(0) {
+}
+
+ProfileWriter::~ProfileWriter() {
+    stop();
+}
+
+void ProfileWriter::push(const DecodedFrame& frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() >= QUEUE_LIMIT) {
+        queue_.pop_front();
+        ++dropped_;
+    }
+    queue_.push_back(frame);
+    cond_.notify_one();
+}
+
+void ProfileWriter::start() {
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread(&ProfileWriter::run, this);
+}
+
+void ProfileWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        cond_.notify_one();
+    }
+    if (thread_.joinable()) thread_.join();
+}
+
+void ProfileWriter::run() {
+    std::vector<DecodedFrame> batch;
+    std::vector<long> rowIds;
+    batch.reserve(BATCH);
+    rowIds.reserve(BATCH);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [&]{ return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            while (!queue_.empty() && batch.size() < BATCH) {
+                batch.push_back(queue_.front());
+                queue_.pop_front();
+            }
+        }
+
+        db_.beginTransaction();
+        for (const auto& frame : batch) {
+            long rowId = db_.insert(frame);
+            if (rowId != -1) ++written_;
+            rowIds.push_back(rowId);
+        }
+        db_.commitTransaction();
+        // 提交后再登记行号，此时其它连接已能查到这些行
+        if (storedHandler_) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (rowIds[i] != -1) storedHandler_(batch[i], rowIds[i]);
+            }
+        }
+        batch.clear();
+        rowIds.clear();
+    }
+}
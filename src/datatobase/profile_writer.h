@@ -0,0 +1,58 @@
+// profile_writer.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "decode_program.h"
+#include "profile_database.h"
+
+/*
+ * 唯一的写库线程：各采集线程把解码结果按值入队，
+ * 写线程一次取出已到达的全部帧(最多 BATCH 帧)放在一个事务里写入。
+ * 队列最多 QUEUE_LIMIT 帧(每帧约 0.8KB)，SQLite 长时间卡住(忙、检查点、SD 卡慢)时丢弃最旧的帧并计数，
+ * 内存不会无限增长。
+ */
+class ProfileWriter {
+public:
+    static const size_t BATCH = 50;
+    static const size_t QUEUE_LIMIT = 4096;
+
+    // 一批帧提交后对其中每个写入成功的帧调用一次，rowId 为该帧在库中的 id，在写线程中调用
+    typedef std::function<void(const DecodedFrame& frame, long rowId)> StoredHandler;
+
+    explicit ProfileWriter(ProfileDatabase& db);
+    ~ProfileWriter();
+
+    // 可在任意线程调用
+    void push(const DecodedFrame& frame);
+
+    // 需在 start() 之前设置
+    void onStored(StoredHandler handler) { storedHandler_ = handler; }
+
+    void start();
+    // 写完队列中剩余的帧后退出
+    void stop();
+
+    // 已写入的帧数
+    long written() const { return written_; }
+    // 队列满而丢弃的帧数
+    long dropped() const { return dropped_; }
+
+private:
+    ProfileDatabase& db_;
+    std::deque<DecodedFrame> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stopping_ = false;
+    std::atomic<long> written_;
+    std::atomic<long> dropped_;
+    std::thread thread_;
+    StoredHandler storedHandler_;
+
+    void run();
+};
@@ -0,0 +1,105 @@
+// arm_accel.cpp
+#include "arm_accel.h"
+
+#if defined(__aarch64__)
+
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_neon.h>
+#include <string.h>
+#include "crc16.h"
+
+bool arm_has_pmull()
+{
+    return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+}
+
+bool arm_has_asimd()
+{
+    return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+}
+
+/*
+ * 折叠常数：多项式 P = x^16 + x^15 + x^2 + 1 (0x18005)。
+ * 反射位序下 128bit 块的 bit b 对应 x^(127-b)，
+ * 前一块 A 折叠到后一块时需要 A_lo*x^192 + A_hi*x^128 (mod P)；
+ * 64x64 无进位乘法的结果按 128bit 块解释时会多乘一个 x，因此常数取 x^191、x^127 mod P，
+ * 以 bit j <-> x^(63-j) 的方式存放。
+ */
+namespace {
+
+constexpr uint32_t mulx(uint32_t r)
+{
+    return ((r << 1) & 0x10000) ? ((r << 1) ^ 0x18005) : (r << 1);
+}
+
+constexpr uint32_t xpowModP(int n)
+{
+    return n < 16 ? (1u << n) : mulx(xpowModP(n - 1));
+}
+
+constexpr uint32_t reverse16(uint32_t r, int i = 0)
+{
+    return i == 16 ? 0 : ((((r >> i) & 1) << (15 - i)) | reverse16(r, i + 1));
+}
+
+constexpr uint64_t foldConst(int n)
+{
+    return uint64_t(reverse16(xpowModP(n))) << 48;
+}
+
+constexpr uint64_t K_LO = foldConst(191);
+constexpr uint64_t K_HI = foldConst(127);
+
+// 短报文折叠不划算，直接查表
+const size_t PMULL_MIN_LEN = 64;
+
+}
+
+__attribute__((target("+crypto")))
+uint16_t crc16_modbus_pmull(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    if (len < PMULL_MIN_LEN) {
+        return crc16_modbus_portable(crc, buf, len);
+    }
+
+    // 初值等价于异或进前两个字节，之后按余式为 0 计算
+    uint64x2_t x = vreinterpretq_u64_u8(vld1q_u8(buf));
+    x = veorq_u64(x, vcombine_u64(vcreate_u64(crc), vcreate_u64(0)));
+    buf += 16;
+    len -= 16;
+
+    while (len >= 16) {
+        poly128_t lo = vmull_p64((poly64_t)vgetq_lane_u64(x, 0), (poly64_t)K_LO);
+        poly128_t hi = vmull_p64((poly64_t)vgetq_lane_u64(x, 1), (poly64_t)K_HI);
+        x = veorq_u64(vreinterpretq_u64_p128(lo), vreinterpretq_u64_p128(hi));
+        x = veorq_u64(x, vreinterpretq_u64_u8(vld1q_u8(buf)));
+        buf += 16;
+        len -= 16;
+    }
+
+    // 剩下的 128bit 与原报文同余，查表算出余式后接着处理尾部
+    uint8_t folded[16];
+    vst1q_u8(folded, vreinterpretq_u8_u64(x));
+    crc = crc16_modbus_portable(0, folded, sizeof(folded));
+    return crc16_modbus_portable(crc, buf, len);
+}
+
+uint8_t checksum_sum8_neon(const uint8_t *buf, size_t len)
+{
+    // 只需要 mod 256 的和，8bit 通道自然回绕即可
+    uint8x16_t acc = vdupq_n_u8(0);
+    while (len >= 16) {
+        acc = vaddq_u8(acc, vld1q_u8(buf));
+        buf += 16;
+        len -= 16;
+    }
+
+    uint8_t sum = vaddvq_u8(acc);
+    while (len--) {
+        sum += *buf++;
+    }
+    return sum;
+}
+
+#endif
@@ -0,0 +1,24 @@
+// arm_accel.h
+#ifndef _ARM_ACCEL_H
+#define _ARM_ACCEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * ARMv8 加速内核(仅 aarch64 编译)，由 crc16.cpp / checksum.cpp 在运行时按 HWCAP 选择，
+ * 其它平台只使用可移植实现。
+ */
+#if defined(__aarch64__)
+
+bool arm_has_pmull();
+bool arm_has_asimd();
+
+// PMULL 128bit 折叠 + 查表收尾
+uint16_t crc16_modbus_pmull(uint16_t crc, const uint8_t *buf, size_t len);
+// NEON 16 字节并行累加
+uint8_t checksum_sum8_neon(const uint8_t *buf, size_t len);
+
+#endif
+
+#endif
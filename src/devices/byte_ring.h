@@ -0,0 +1,108 @@
+// byte_ring.h
+#ifndef _BYTE_RING_H
+#define _BYTE_RING_H
+
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+
+/*
+ * 单生产者/单消费者无锁环形字节缓冲，容量必须为 2 的幂。
+ * 读写下标自由递增，取模用掩码；数据只在写入时拷贝一次，
+ * 丢弃字节只移动读下标，不做 memmove 压缩。
+ */
+template <uint32_t N>
+class ByteRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "ByteRing capacity must be a power of two");
+
+public:
+    static constexpr uint32_t CAPACITY = N;
+
+    ByteRing() : head_(0), tail_(0) {}
+
+    // 可读字节数
+    uint32_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+
+    // 剩余空间
+    uint32_t space() const {
+        return N - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire));
+    }
+
+    // 自由递增的写/读下标(不取模)，可用来标记某段数据在流中的位置
+    uint32_t writeIndex() const { return head_.load(std::memory_order_acquire); }
+    uint32_t readIndex() const { return tail_.load(std::memory_order_acquire); }
+
+    // ---- 生产者 ----
+
+    // 写入数据，返回实际写入的字节数(空间不足时截断)
+    uint32_t write(const uint8_t* data, uint32_t len) {
+        uint32_t free = space();
+        if (len > free) len = free;
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        uint32_t pos = head & (N - 1);
+        uint32_t first = N - pos;
+        if (first > len) first = len;
+        std::memcpy(buf_ + pos, data, first);
+        std::memcpy(buf_, data + first, len - first);
+        head_.store(head + len, std::memory_order_release);
+        return len;
+    }
+
+    // 取得可直接写入的连续空间(供 read() 直接落入环形缓冲)
+    uint8_t* writeSpan(uint32_t& contiguous) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        uint32_t pos = head & (N - 1);
+        uint32_t free = space();
+        contiguous = (N - pos < free) ? N - pos : free;
+        return buf_ + pos;
+    }
+
+    // 提交 writeSpan() 中实际写入的字节
+    void produce(uint32_t len) {
+        head_.store(head_.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+    // ---- 消费者 ----
+
+    // 读位置之后第 offset 个字节
+    uint8_t peek(uint32_t offset) const {
+        return buf_[(tail_.load(std::memory_order_relaxed) + offset) & (N - 1)];
+    }
+
+    // 从读位置之后第 offset 个字节开始最长的连续可读区
+    const uint8_t* readSpan(uint32_t offset, uint32_t& contiguous) const {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        uint32_t pos = (tail + offset) & (N - 1);
+        uint32_t avail = size();
+        avail = (avail > offset) ? avail - offset : 0;
+        contiguous = (N - pos < avail) ? N - pos : avail;
+        return buf_ + pos;
+    }
+
+    // 取 [offset, offset+len) 的连续视图：不跨越环尾时直接返回内部指针(零拷贝)，
+    // 跨越时才拼接到 scratch 中
+    const uint8_t* span(uint32_t offset, uint32_t len, uint8_t* scratch) const {
+        uint32_t pos = (tail_.load(std::memory_order_relaxed) + offset) & (N - 1);
+        if (pos + len <= N) {
+            return buf_ + pos;
+        }
+        uint32_t first = N - pos;
+        std::memcpy(scratch, buf_ + pos, first);
+        std::memcpy(scratch + first, buf_, len - first);
+        return scratch;
+    }
+
+    // 丢弃 len 个字节
+    void consume(uint32_t len) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+private:
+    uint8_t buf_[N];
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> tail_;
+};
+
+#endif
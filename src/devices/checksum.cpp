@@ -0,0 +1,42 @@
+// checksum.cpp
+#include "checksum.h"
+#include "arm_accel.h"
+
+uint8_t checksum_sum8_portable(const uint8_t *buf, size_t len)
+{
+    uint8_t sum = 0;
+    while (len--) {
+        sum += *buf++;
+    }
+    return sum;
+}
+
+typedef uint8_t (*Sum8Kernel)(const uint8_t *buf, size_t len);
+
+struct Sum8Impl {
+    Sum8Kernel kernel;
+    const char *name;
+};
+
+// 首次调用时按 CPU 能力选择实现
+static const Sum8Impl &sum8Impl()
+{
+#if defined(__aarch64__)
+    static const Sum8Impl impl = arm_has_asimd()
+        ? Sum8Impl{ checksum_sum8_neon, "neon" }
+        : Sum8Impl{ checksum_sum8_portable, "scalar" };
+#else
+    static const Sum8Impl impl = { checksum_sum8_portable, "scalar" };
+#endif
+    return impl;
+}
+
+const char *checksum_sum8_impl()
+{
+    return sum8Impl().name;
+}
+
+uint8_t checksum_sum8(const uint8_t *buf, size_t len)
+{
+    return sum8Impl().kernel(buf, len);
+}
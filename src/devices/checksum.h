@@ -0,0 +1,14 @@
+// checksum.h
+#ifndef _CHECKSUM_H
+#define _CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 逐字节累加和(mod 256)，FA F5 帧整帧累加应为 0；aarch64 上自动选用 NEON 实现
+uint8_t checksum_sum8(const uint8_t *buf, size_t len);
+
+uint8_t checksum_sum8_portable(const uint8_t *buf, size_t len);
+const char *checksum_sum8_impl();
+
+#endif
@@ -1,71 +1,109 @@
 #include <stdint.h>
-unsigned int calc_crc16(unsigned char *buf,  int len)
+#include "crc16.h"
+#include "arm_accel.h"
+
+/*
+ * 查表在编译期生成：
+ *   T0[n] = 单字节 n 的 CRC 余式
+ *   Tk[n] = 字节 n 后再跟 k 个 0 字节的 CRC 余式
+ * slice-by-8 每次同时查 8 张表，处理 8 个字节。
+ */
+namespace {
+
+constexpr uint16_t crcShift(uint16_t c, int bits)
 {
-    unsigned int index;
-    unsigned char crch = 0xFF;  //高CRC字节
-    unsigned char crcl = 0xFF;  //低CRC字节
-    unsigned char TabH[] = {  //CRC高位字节值表
-        0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0,  
-        0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,  
-        0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0,  
-        0x80, 0x41, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,  
-        0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1,  
-        0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,  
-        0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1,  
-        0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,  
-        0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0,  
-        0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40,  
-        0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1,  
-        0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,  
-        0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0,  
-        0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40,  
-        0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0,  
-        0x80, 0x41, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,  
-        0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0,  
-        0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,  
-        0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0,  
-        0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,  
-        0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0,  
-        0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40,  
-        0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1,  
-        0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,  
-        0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0,  
-        0x80, 0x41, 0x00, 0xC1, 0x81, 0x40  
-    };  
-    unsigned char TabL[] = {  //CRC低位字节值表
-        0x00, 0xC0, 0xC1, 0x01, 0xC3, 0x03, 0x02, 0xC2, 0xC6, 0x06,  
-        0x07, 0xC7, 0x05, 0xC5, 0xC4, 0x04, 0xCC, 0x0C, 0x0D, 0xCD,  
-        0x0F, 0xCF, 0xCE, 0x0E, 0x0A, 0xCA, 0xCB, 0x0B, 0xC9, 0x09,  
-        0x08, 0xC8, 0xD8, 0x18, 0x19, 0xD9, 0x1B, 0xDB, 0xDA, 0x1A,  
-        0x1E, 0xDE, 0xDF, 0x1F, 0xDD, 0x1D, 0x1C, 0xDC, 0x14, 0xD4,  
-        0xD5, 0x15, 0xD7, 0x17, 0x16, 0xD6, 0xD2, 0x12, 0x13, 0xD3,  
-        0x11, 0xD1, 0xD0, 0x10, 0xF0, 0x30, 0x31, 0xF1, 0x33, 0xF3,  
-        0xF2, 0x32, 0x36, 0xF6, 0xF7, 0x37, 0xF5, 0x35, 0x34, 0xF4,  
-        0x3C, 0xFC, 0xFD, 0x3D, 0xFF, 0x3F, 0x3E, 0xFE, 0xFA, 0x3A,  
-        0x3B, 0xFB, 0x39, 0xF9, 0xF8, 0x38, 0x28, 0xE8, 0xE9, 0x29,  
-        0xEB, 0x2B, 0x2A, 0xEA, 0xEE, 0x2E, 0x2F, 0xEF, 0x2D, 0xED,  
-        0xEC, 0x2C, 0xE4, 0x24, 0x25, 0xE5, 0x27, 0xE7, 0xE6, 0x26,  
-        0x22, 0xE2, 0xE3, 0x23, 0xE1, 0x21, 0x20, 0xE0, 0xA0, 0x60,  
-        0x61, 0xA1, 0x63, 0xA3, 0xA2, 0x62, 0x66, 0xA6, 0xA7, 0x67,  
-        0xA5, 0x65, 0x64, 0xA4, 0x6C, 0xAC, 0xAD, 0x6D, 0xAF, 0x6F,  
-        0x6E, 0xAE, 0xAA, 0x6A, 0x6B, 0xAB, 0x69, 0xA9, 0xA8, 0x68,  
-        0x78, 0xB8, 0xB9, 0x79, 0xBB, 0x7B, 0x7A, 0xBA, 0xBE, 0x7E,  
-        0x7F, 0xBF, 0x7D, 0xBD, 0xBC, 0x7C, 0xB4, 0x74, 0x75, 0xB5,  
-        0x77, 0xB7, 0xB6, 0x76, 0x72, 0xB2, 0xB3, 0x73, 0xB1, 0x71,  
-        0x70, 0xB0, 0x50, 0x90, 0x91, 0x51, 0x93, 0x53, 0x52, 0x92,  
-        0x96, 0x56, 0x57, 0x97, 0x55, 0x95, 0x94, 0x54, 0x9C, 0x5C,  
-        0x5D, 0x9D, 0x5F, 0x9F, 0x9E, 0x5E, 0x5A, 0x9A, 0x9B, 0x5B,  
-        0x99, 0x59, 0x58, 0x98, 0x88, 0x48, 0x49, 0x89, 0x4B, 0x8B,  
-        0x8A, 0x4A, 0x4E, 0x8E, 0x8F, 0x4F, 0x8D, 0x4D, 0x4C, 0x8C,  
-        0x44, 0x84, 0x85, 0x45, 0x87, 0x47, 0x46, 0x86, 0x82, 0x42,  
-        0x43, 0x83, 0x41, 0x81, 0x80, 0x40  
-    };
-    while (len--)  //计算指定长度的CRC
-    {
-        index = crch ^ *buf++;
-        crch = crcl ^ TabH[ index];
-        crcl = TabL[ index];
+    return bits == 0 ? c : crcShift((c & 1) ? uint16_t((c >> 1) ^ 0xA001) : uint16_t(c >> 1), bits - 1);
+}
+
+constexpr uint16_t crcT0(int n)
+{
+    return crcShift(uint16_t(n), 8);
+}
+
+constexpr uint16_t crcTk(int k, int n)
+{
+    return k == 0 ? crcT0(n)
+                  : uint16_t((crcTk(k - 1, n) >> 8) ^ crcT0(crcTk(k - 1, n) & 0xFF));
+}
+
+template <int... I> struct IndexSeq {};
+template <int N, int... I> struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndexSeq<0, I...> { typedef IndexSeq<I...> type; };
+
+struct CrcTable {
+    uint16_t t[8][256];
+};
+
+template <int... I>
+constexpr CrcTable makeCrcTable(IndexSeq<I...>)
+{
+    return CrcTable{{ { crcTk(0, I)... }, { crcTk(1, I)... }, { crcTk(2, I)... }, { crcTk(3, I)... },
+                      { crcTk(4, I)... }, { crcTk(5, I)... }, { crcTk(6, I)... }, { crcTk(7, I)... } }};
+}
+
+constexpr CrcTable kCrc = makeCrcTable(MakeIndexSeq<256>::type());
+
+static_assert(kCrc.t[0][1] == 0xC0C1, "CRC16 table generation broken");
+
+}
+
+uint16_t crc16_modbus_portable(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    const uint16_t (*T)[256] = kCrc.t;
+
+    // slice-by-8
+    while (len >= 8) {
+        crc = T[7][(buf[0] ^ crc) & 0xFF] ^ T[6][(buf[1] ^ (crc >> 8)) & 0xFF]
+            ^ T[5][buf[2]] ^ T[4][buf[3]] ^ T[3][buf[4]]
+            ^ T[2][buf[5]] ^ T[1][buf[6]] ^ T[0][buf[7]];
+        buf += 8;
+        len -= 8;
+    }
+
+    // 剩余不足 8 字节逐字节处理
+    while (len--) {
+        crc = (crc >> 8) ^ T[0][(crc ^ *buf++) & 0xFF];
     }
-   
-    return ((crch<<8) | crcl);  
-}  
\ No newline at end of file
+    return crc;
+}
+
+typedef uint16_t (*Crc16Kernel)(uint16_t crc, const uint8_t *buf, size_t len);
+
+struct Crc16Impl {
+    Crc16Kernel kernel;
+    const char *name;
+};
+
+// 首次调用时按 CPU 能力选择实现
+static const Crc16Impl &crc16Impl()
+{
+#if defined(__aarch64__)
+    static const Crc16Impl impl = arm_has_pmull()
+        ? Crc16Impl{ crc16_modbus_pmull, "pmull" }
+        : Crc16Impl{ crc16_modbus_portable, "slice-by-8" };
+#else
+    static const Crc16Impl impl = { crc16_modbus_portable, "slice-by-8" };
+#endif
+    return impl;
+}
+
+const char *crc16_modbus_impl()
+{
+    return crc16Impl().name;
+}
+
+uint16_t crc16_modbus_update(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    return crc16Impl().kernel(crc, buf, len);
+}
+
+uint16_t crc16_modbus(const uint8_t *buf, size_t len)
+{
+    return crc16_modbus_update(0xFFFF, buf, len);
+}
+
+uint16_t calc_crc16(unsigned char *buf, int len)
+{
+    uint16_t crc = crc16_modbus(buf, len);
+    return uint16_t((crc << 8) | (crc >> 8));
+}
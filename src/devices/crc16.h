@@ -0,0 +1,35 @@
+// crc16.h
+#ifndef _CRC16_H
+#define _CRC16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Modbus RTU CRC16 (多项式 0xA001 反射, 初值 0xFFFF)。
+ * 返回标准 CRC 值，报文中低字节在前：buf[n-2] = crc & 0xFF, buf[n-1] = crc >> 8
+ */
+uint16_t crc16_modbus(const uint8_t *buf, size_t len);
+
+// 在已有 CRC 基础上继续计算(分段校验)
+uint16_t crc16_modbus_update(uint16_t crc, const uint8_t *buf, size_t len);
+
+// 可移植的 slice-by-8 实现；上面两个接口在 aarch64 上会自动选用 PMULL 实现
+uint16_t crc16_modbus_portable(uint16_t crc, const uint8_t *buf, size_t len);
+const char *crc16_modbus_impl();
+
+// 增量计算
+class Crc16Modbus {
+    public:
+        Crc16Modbus() : crc(0xFFFF) {}
+        void reset() { crc = 0xFFFF; }
+        void update(const uint8_t *buf, size_t len) { crc = crc16_modbus_update(crc, buf, len); }
+        uint16_t value() const { return crc; }
+    private:
+        uint16_t crc;
+};
+
+// 旧接口：返回值高字节为报文中先发送的字节，即 (buf[n-2] << 8) | buf[n-1]
+uint16_t calc_crc16(unsigned char *buf, int len);
+
+#endif
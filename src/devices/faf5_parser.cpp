@@ -0,0 +1,155 @@
+// faf5_parser.cpp
+#include "faf5_parser.h"
+#include "checksum.h"
+#include <cstring>
+
+FaF5Parser::FaF5Parser()
+  : state(HUNT), pos(0), frameLen_(0), sum(0), lengthCount(0),
+    markHead(0), markCount(0)
+{
+    frameRx.monoNs = 0;
+    frameRx.realNs = 0;
+}
+
+uint32_t FaF5Parser::feed(const uint8_t* data, uint32_t len, const RxTimestamp& rx)
+{
+    uint32_t n = ring.write(data, len);
+    if (n > 0) addMark(rx);
+    return n;
+}
+
+void FaF5Parser::produce(uint32_t len, const RxTimestamp& rx)
+{
+    ring.produce(len);
+    if (len > 0) addMark(rx);
+}
+
+// 记录本次写入结束的位置；标记满时覆盖最早的(其数据必然早已被处理)
+void FaF5Parser::addMark(const RxTimestamp& rx)
+{
+    int idx = (markHead + markCount) % MAX_MARKS;
+    if (markCount == MAX_MARKS) {
+        markHead = (markHead + 1) % MAX_MARKS;
+    } else {
+        ++markCount;
+    }
+    marks[idx].end = ring.writeIndex();
+    marks[idx].rx = rx;
+}
+
+// 帧的最后一个字节所在的那次写入，其时间即帧接收时间
+void FaF5Parser::stampFrame()
+{
+    uint32_t frameEnd = ring.readIndex() + frameLen_;
+    while (markCount > 0) {
+        const RxMark& m = marks[markHead];
+        if (int32_t(m.end - frameEnd) >= 0) {
+            frameRx = m.rx;
+            return;
+        }
+        markHead = (markHead + 1) % MAX_MARKS;
+        --markCount;
+    }
+}
+
+bool FaF5Parser::addFrameLength(uint16_t len)
+{
+    if (len < MIN_FRAME || len > MAX_FRAME || lengthCount >= MAX_LENGTHS) {
+        return false;
+    }
+    lengths[lengthCount++] = len;
+    return true;
+}
+
+bool FaF5Parser::accepted(uint16_t len) const
+{
+    for (int i = 0; i < lengthCount; ++i) {
+        if (lengths[i] == len) return true;
+    }
+    return false;
+}
+
+// 当前帧头是误判：只丢弃 FA 这一个字节，从下一字节重新搜帧
+void FaF5Parser::resync()
+{
+    ring.consume(1);
+    state = HUNT;
+    pos = 0;
+}
+
+const uint8_t* FaF5Parser::next(int& frameLen)
+{
+    if (state == READY) {
+        frameLen = frameLen_;
+        return ring.span(0, frameLen_, scratch);
+    }
+
+    while (true) {
+        uint32_t contiguous = 0;
+        const uint8_t* p = ring.readSpan(pos, contiguous);
+        if (contiguous == 0) return nullptr;
+
+        switch (state) {
+        case HUNT: {
+            // 整块 memchr 找 0xFA，之前的字节直接丢弃
+            const void* hit = memchr(p, 0xFA, contiguous);
+            if (!hit) {
+                ring.consume(contiguous);
+                break;
+            }
+            ring.consume(static_cast<const uint8_t*>(hit) - p);
+            sum = 0xFA;
+            pos = 1;
+            state = HEAD2;
+            break;
+        }
+        case HEAD2:
+            if (p[0] != 0xF5) { resync(); break; }
+            sum += p[0];
+            ++pos;
+            state = LEN_HI;
+            break;
+        case LEN_HI:
+            frameLen_ = uint16_t(p[0]) << 8;
+            sum += p[0];
+            ++pos;
+            state = LEN_LO;
+            break;
+        case LEN_LO:
+            frameLen_ |= p[0];
+            if (!accepted(frameLen_)) { resync(); break; }
+            sum += p[0];
+            ++pos;
+            state = BODY;
+            break;
+        case BODY: {
+            // 数据区(含校验字节)按连续块累加，直到只剩最后一个字节
+            uint32_t n = frameLen_ - 1 - pos;
+            if (n > contiguous) n = contiguous;
+            sum += checksum_sum8(p, n);
+            pos += n;
+            if (pos == uint32_t(frameLen_ - 1)) state = CHECK;
+            break;
+        }
+        case CHECK:
+            sum += p[0];
+            if (sum != 0) { resync(); break; }
+            pos = frameLen_;
+            state = READY;
+            stampFrame();
+            frameLen = frameLen_;
+            return ring.span(0, frameLen_, scratch);
+        case READY:
+            break;
+        }
+    }
+}
+
+// 丢弃 next() 返回的帧，继续搜下一帧
+void FaF5Parser::release()
+{
+    if (state != READY) return;
+    ring.consume(frameLen_);
+    state = HUNT;
+    pos = 0;
+}
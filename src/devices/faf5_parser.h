@@ -0,0 +1,75 @@
+// faf5_parser.h
+#ifndef _FAF5_PARSER_H
+#define _FAF5_PARSER_H
+
+#include <stdint.h>
+#include "byte_ring.h"
+#include "rx_timestamp.h"
+
+/*
+ * FA F5 帧协议的增量式流解析器：
+ *   FA F5 | 长度高 | 长度低 | 数据 ... | 校验 | 2字节
+ * 长度字段为整帧字节数，整帧所有字节(含校验字节)累加 mod 256 为 0。
+ *
+ * 状态机 HUNT -> HEAD2 -> LEN_HI -> LEN_LO -> BODY -> CHECK，
+ * 校验和随字节到达累加，每个输入字节只处理一次；
+ * 最后一个字节到达即完成校验。只有校验失败时才回到帧头后一字节重新搜帧。
+ */
+class FaF5Parser {
+public:
+    static constexpr uint32_t RING_CAP     = 256; // 必须为 2 的幂
+    static constexpr int      MIN_FRAME    = 7;
+    static constexpr int      MAX_FRAME    = 64;
+    static constexpr int      MAX_LENGTHS  = 4;
+
+    FaF5Parser();
+
+    // 允许的帧长度(长度字段取值)，不在列表中的帧头视为误判
+    bool addFrameLength(uint16_t len);
+
+    // ---- 输入 ----
+    // rx 为这批数据被读到的时间，完成某帧的那次读取的时间即该帧的接收时间
+    uint32_t feed(const uint8_t* data, uint32_t len, const RxTimestamp& rx);
+    uint8_t* writeSpan(uint32_t& contiguous) { return ring.writeSpan(contiguous); }
+    void     produce(uint32_t len, const RxTimestamp& rx);
+
+    // ---- 输出 ----
+    // 推进状态机，得到完整帧时返回帧首指针(零拷贝)并给出帧长，
+    // 指针在 release() 之前有效；数据不足时返回 nullptr
+    const uint8_t* next(int& frameLen);
+    void release();
+    // next() 返回的帧的接收时间
+    const RxTimestamp& frameTime() const { return frameRx; }
+
+private:
+    enum State { HUNT, HEAD2, LEN_HI, LEN_LO, BODY, CHECK, READY };
+
+    ByteRing<RING_CAP> ring;
+    uint8_t  scratch[MAX_FRAME];   // 帧跨越环尾时的拼接区
+
+    State    state;
+    uint32_t pos;                  // 下一个待处理字节相对读位置的偏移
+    uint16_t frameLen_;
+    uint8_t  sum;
+
+    uint16_t lengths[MAX_LENGTHS];
+    int      lengthCount;
+
+    // 每次写入的结束位置及其读取时间
+    struct RxMark {
+        uint32_t    end;
+        RxTimestamp rx;
+    };
+    static constexpr int MAX_MARKS = 16;
+    RxMark   marks[MAX_MARKS];
+    int      markHead;
+    int      markCount;
+    RxTimestamp frameRx;
+
+    bool accepted(uint16_t len) const;
+    void resync();
+    void addMark(const RxTimestamp& rx);
+    void stampFrame();
+};
+
+#endif
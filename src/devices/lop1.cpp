@@ -1,13 +1,21 @@
 // lop1.cpp
 #include "lop1.h"
+#include "checksum.h"
 #include <cstring>
 #include <iostream>
 using namespace std;
 
 Lop1::Lop1(const string& deviceName,int baudRate)
-  : deviceName(deviceName), baudRate(baudRate)
+  : Lop1(deviceName, UartConfig(baudRate))
 {
-    uart = new LinuxUart(deviceName, baudRate);
+}
+
+Lop1::Lop1(const string& deviceName,const UartConfig& config)
+  : deviceName(deviceName), config(config)
+{
+    uart = new LinuxUart(deviceName, config);
+    parser.addFrameLength(FRAME1_LEN);
+    parser.addFrameLength(FRAME2_LEN);
 }
 
 Lop1::~Lop1(){
@@ -15,61 +23,98 @@ Lop1::~Lop1(){
 }
 
 bool Lop1::initialize(){
-    return uart->defaultInit(baudRate);
+    return uart->configure(config);
 }
 
-// 第一种帧接收
-bool Lop1::receiveData1(uint8_t* frameBuf)
+// 追加外部(如 SerialReactor)读到的数据，返回实际接收的字节数
+int Lop1::feedData(const uint8_t* data, int len, const RxTimestamp& rx)
 {
-    // 1) 读串口
-    int r = uart->readData(tempBuffer + tempBufferLen,
-                           TEMP_CAP - tempBufferLen);
+    return parser.feed(data, len, rx);
+}
+
+// 串口数据直接读入解析器环形缓冲的连续空闲区
+bool Lop1::readToRing()
+{
+    uint32_t contiguous = 0;
+    uint8_t* dst = parser.writeSpan(contiguous);
+    if (contiguous == 0) return false;
+    int r = uart->readData(dst, contiguous);
     if (r <= 0) return false;
-    tempBufferLen += r;
-
-    // 2) 搜帧头 FA F5
-    for (int i = 0; i <= tempBufferLen - MIN_FRAME; ++i) {
-        if (tempBuffer[i] == 0xFA && tempBuffer[i+1] == 0xF5) {
-            // 3) 取长度
-            uint16_t frameLen = (uint16_t(tempBuffer[i+2]) << 8)
-                              | uint16_t(tempBuffer[i+3]);
-            if (frameLen != FRAME1_LEN) continue;
-            //if (frameLen < MIN_FRAME || frameLen > TEMP_CAP) continue;
-            
-            // 4) 不够整帧？等下次
-            if (tempBufferLen - i < frameLen) {
-                break;
-            }
-
-            // 5) 校验 checksum
-            if (!validateFrame1(tempBuffer + i)) {
-                // 验证失败，跳过这个头，下一个 i
-                continue;
-            }
-
-            // 6) 验证通过，拷贝整帧到用户缓冲
-            memcpy(frameBuf, tempBuffer + i, frameLen);
-
-            // 7) 丢弃已处理的整帧
-            int remain = tempBufferLen - (i + frameLen);
-            memmove(tempBuffer,
-                    tempBuffer + i + frameLen,
-                    remain);
-            tempBufferLen = remain;
-            return true;
-        }
-    }
+    parser.produce(r, uart->lastReadTime());
+    return true;
+}
 
-    // 8) 缓冲保护，避免 tempBuffer 无限制增长
-    if (tempBufferLen > TEMP_CAP/2) {
-        memmove(tempBuffer,
-                tempBuffer + tempBufferLen - 4,
-                4);
-        tempBufferLen = 4;
+/*
+ * 取下一帧指定长度的帧(零拷贝，帧仍留在缓冲中)。
+ * 解析器逐字节推进、边收边累加校验和，另一种长度的帧在这里被跳过。
+ */
+const uint8_t* Lop1::nextFrame(int wantLen)
+{
+    int frameLen = 0;
+    const uint8_t* frame;
+    while ((frame = parser.next(frameLen)) != nullptr) {
+        if (frameLen == wantLen) return frame;
+        parser.release();
     }
-    return false;
+    return nullptr;
+}
+
+// 丢弃 peekFrameN() 返回的帧
+void Lop1::dropFrame()
+{
+    parser.release();
+}
+
+const uint8_t* Lop1::peekFrame1()
+{
+    return nextFrame(FRAME1_LEN);
+}
+
+const uint8_t* Lop1::peekFrame2()
+{
+    return nextFrame(FRAME2_LEN);
+}
+
+// 读一次串口，返回下一帧(不区分类型)
+bool Lop1::receiveAny(FrameView& view)
+{
+    if (extractAny(view)) return true;
+    if (!readToRing()) return false;
+    return extractAny(view);
+}
+
+// 从已缓存数据中取出下一帧，并释放上一次返回的帧
+bool Lop1::extractAny(FrameView& view)
+{
+    parser.release();
+
+    int frameLen = 0;
+    const uint8_t* frame = parser.next(frameLen);
+    if (!frame) return false;
+
+    view.type = (frameLen == FRAME1_LEN) ? FRAME1 : FRAME2;
+    view.data = frame;
+    view.len  = frameLen;
+    view.rx   = parser.frameTime();
+    return true;
+}
+
+// 第一种帧接收
+bool Lop1::receiveData1(uint8_t* frameBuf)
+{
+    if (!readToRing()) return false;
+    return extractFrame1(frameBuf);
 }
 
+// 从已缓存数据中取出一帧第一种帧
+bool Lop1::extractFrame1(uint8_t* frameBuf)
+{
+    const uint8_t* frame = peekFrame1();
+    if (!frame) return false;
+    memcpy(frameBuf, frame, FRAME1_LEN);
+    dropFrame();
+    return true;
+}
 
 bool Lop1::validateFrame1(const uint8_t* frameBuf) const {
     // 1) 从报文 [2..3] 取 frameLen
@@ -80,18 +125,9 @@ bool Lop1::validateFrame1(const uint8_t* frameBuf) const {
     //    return false;  // 长度不合理
     
 
-    // 2) 校验位位于 frameLen-3
-    int csIdx = frameLen - 3;
-
-    // 3) 对除了 checksum 自身以外的所有字节累加（uint8_t 自动 mod256）
-    uint8_t sum = 0;
-    for (int i = 0; i < frameLen; ++i) {
-        if (i == csIdx) continue;
-        sum += frameBuf[i];
-    }
-
-    // 4) 加上 checksum 后，应该正好回到 0
-    return uint8_t(sum + frameBuf[csIdx]) == 0;
+    // 2) 校验位位于 frameLen-3，其余字节累加后再加上 checksum 应正好回到 0，
+    //    即整帧累加（uint8_t 自动 mod256）为 0
+    return checksum_sum8(frameBuf, frameLen) == 0;
 }
 
 void Lop1::printReceivedData1(const uint8_t* buffer) {
@@ -106,49 +142,25 @@ void Lop1::printReceivedData1(const uint8_t* buffer) {
 // 第二种帧接收
 bool Lop1::receiveData2(uint8_t* frameBuf)
 {
-    int r = uart->readData(tempBuffer + tempBufferLen,
-                           TEMP_CAP - tempBufferLen);
-    if (r <= 0) return false;
-    tempBufferLen += r;
-
-    for (int i = 0; i <= tempBufferLen - MIN_FRAME; ++i) {
-        if (tempBuffer[i] == 0xFA && tempBuffer[i+1] == 0xF5) {
-            uint16_t frameLen = (uint16_t(tempBuffer[i+2]) << 8)
-                              | uint16_t(tempBuffer[i+3]);
-            // 只接受 32 字节这一路径
-            if (frameLen != FRAME2_LEN) continue;
-            if (tempBufferLen - i < frameLen) break;
-            if (!validateFrame2(tempBuffer + i)) { continue; }
-            memcpy(frameBuf, tempBuffer + i, frameLen);
-            int rem = tempBufferLen - (i + frameLen);
-            memmove(tempBuffer,
-                    tempBuffer + i + frameLen,
-                    rem);
-            tempBufferLen = rem;
-            return true;
-        }
-    }
+    if (!readToRing()) return false;
+    return extractFrame2(frameBuf);
+}
 
-    if (tempBufferLen > TEMP_CAP/2) {
-        memmove(tempBuffer,
-                tempBuffer + tempBufferLen - 4,
-                4);
-        tempBufferLen = 4;
-    }
-    return false;
+// 从已缓存数据中取出一帧第二种帧
+bool Lop1::extractFrame2(uint8_t* frameBuf)
+{
+    const uint8_t* frame = peekFrame2();
+    if (!frame) return false;
+    memcpy(frameBuf, frame, FRAME2_LEN);
+    dropFrame();
+    return true;
 }
 
 bool Lop1::validateFrame2(const uint8_t* frameBuf) const {
     uint16_t frameLen = (uint16_t(frameBuf[2]) << 8)
                       | uint16_t(frameBuf[3]);
     if (frameLen != FRAME2_LEN) return false;
-    int csIdx = frameLen - 3;
-    uint8_t sum = 0;
-    for (int i = 0; i < frameLen; ++i) {
-        if (i == csIdx) continue;
-        sum += frameBuf[i];
-    }
-    return uint8_t(sum + frameBuf[csIdx]) == 0;
+    return checksum_sum8(frameBuf, frameLen) == 0;
 }
 
 void Lop1::printReceivedData2(const uint8_t* buffer) {
@@ -3,38 +3,68 @@
 #define _LOP1_H
 
 #include "linux_uart.h"
+#include "faf5_parser.h"
 #include <string>
 using namespace std;
 
+enum FrameType { FRAME1, FRAME2 };
+
+// 一帧的零拷贝视图，data 在下一次取帧之前有效
+struct FrameView {
+    FrameType      type;
+    const uint8_t* data;
+    int            len;
+    RxTimestamp    rx;     // 收到帧最后一个字节的那次读取的时间
+};
+
 class Lop1 {
 public:
     Lop1(const string &deviceName, int baudRate = 9600);
+    Lop1(const string &deviceName, const UartConfig &config);
     ~Lop1();
 
-    static constexpr int TEMP_CAP    = 128;
     static constexpr int MIN_FRAME   = 7;
     static constexpr int FRAME1_LEN  = 35;  // 长度字段 0x0023
     static constexpr int FRAME2_LEN  = 32;  // 长度字段 0x0020
 
     bool initialize();
+    LinuxUart& port() { return *uart; }
+
+    // 外部读到数据后喂入(配合 SerialReactor 使用)
+    int  feedData(const uint8_t* data, int len, const RxTimestamp& rx);
+
+    // 任意类型帧：同一端口交替发送两种帧时，一个读线程即可全部接收
+    bool receiveAny(FrameView& view);
+    bool extractAny(FrameView& view);
+
+    // 零拷贝取帧：返回的指针在 dropFrame() 之前有效
+    const uint8_t* peekFrame1();
+    const uint8_t* peekFrame2();
+    void dropFrame();
+    // 最近一次取出(peek/extract/receive)的帧的接收时间
+    const RxTimestamp& frameTime() const { return parser.frameTime(); }
 
     // 第一种帧
     bool receiveData1(uint8_t* buffer);
+    bool extractFrame1(uint8_t* buffer);
     bool validateFrame1(const uint8_t* frameBuf) const;
     void printReceivedData1(const uint8_t* buffer);
 
     // 第二种帧
     bool receiveData2(uint8_t* buffer);
+    bool extractFrame2(uint8_t* buffer);
     bool validateFrame2(const uint8_t* frameBuf) const;
     void printReceivedData2(const uint8_t* buffer);
 
 private:
     LinuxUart *uart;
     string deviceName;
-    int baudRate;
+    UartConfig config;
+
+    FaF5Parser parser;
 
-    uint8_t tempBuffer[TEMP_CAP];
-    int     tempBufferLen = 0;
+    bool readToRing();
+    const uint8_t* nextFrame(int wantLen);
 };
 
 #endif
@@ -4,16 +4,23 @@
 
 using namespace std;
 
-Lop2::Lop2(const string& deviceName,int baudRate):deviceName(deviceName),baudRate(baudRate){
-    uart = new LinuxUart(deviceName, baudRate);
+Lop2::Lop2(const string& deviceName,int baudRate):Lop2(deviceName, UartConfig(baudRate)){
+}
+
+Lop2::Lop2(const string& deviceName,const UartConfig& config):deviceName(deviceName),config(config){
+    uart = new LinuxUart(deviceName, config);
+    master = new ModbusRtuMaster(*uart);
 }
 
 Lop2::~Lop2(){
+    delete master;
     delete uart;
 }
 
 bool Lop2::initialize(){
-    return uart->defaultInit(baudRate);
+    if (!uart->configure(config)) return false;
+    master->updateTiming();
+    return true;
 }
 //发送以下数据01 03 00 00 00 1E C5 C2
 
@@ -22,18 +29,29 @@ bool Lop2::sendcommand(){
     return uart->writeData(COMMAND,COMMAND_SIZE);
 }
 
+// 按 3.5 字符静默/超时接收，从站无应答时不会一直阻塞
 bool Lop2::receiveData(uint8_t* buffer){
-    return uart->readFixLenData(buffer,FRAME_SIZE);                
+    return master->readResponse(buffer, FRAME_SIZE, FRAME_SIZE) == FRAME_SIZE;
+}
+
+ModbusStatus Lop2::poll(uint8_t* buffer){
+    uint16_t regs[REG_COUNT];
+    ModbusStatus st = master->readHoldingRegisters(SLAVE_ID, REG_START, REG_COUNT, regs);
+    if (st == MODBUS_OK) {
+        int len = 0;
+        memcpy(buffer, master->lastResponse(len), FRAME_SIZE);
+    }
+    return st;
 }
 
 //校验帧是否正确
 bool Lop2::validateFrame(uint8_t* buffer) {
     // 计算接收到的数据的 CRC 校验值，不包括最后两个字节
-    uint16_t calculatedCrc = calc_crc16(buffer, FRAME_SIZE - 2);
+    uint16_t calculatedCrc = crc16_modbus(buffer, FRAME_SIZE - 2);
     // 打印计算得到的 CRC 校验值
     //cout << "Calculated CRC: " <<  calculatedCrc << endl;
-    // 提取接收到的数据的最后两个字节作为 CRC 校验值
-    uint16_t receivedCrc = (buffer[FRAME_SIZE - 2] << 8) | buffer[FRAME_SIZE - 1];
+    // 提取接收到的数据的最后两个字节作为 CRC 校验值(低字节在前)
+    uint16_t receivedCrc = buffer[FRAME_SIZE - 2] | (buffer[FRAME_SIZE - 1] << 8);
     // 比较计算得到的 CRC 校验值和接收到的 CRC 校验值
     if (calculatedCrc == receivedCrc) {
         cout << "Valid Frame Received" << endl;
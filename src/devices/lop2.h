@@ -6,24 +6,29 @@ ww
 #define _LOP2_H
 
 #include "linux_uart.h"
+#include "crc16.h"
+#include "modbus_rtu_master.h"
 #include <string.h>
 
 using namespace std;
 
-extern uint16_t calc_crc16(unsigned char *buf, int len);
-
 class Lop2{
     public:
         Lop2(const string &deviceName, int baudRate = 9600);
+        Lop2(const string &deviceName, const UartConfig &config);
         ~Lop2();
     
     private:
         LinuxUart *uart;
+        ModbusRtuMaster *master;
         string deviceName;
-        int baudRate;
+        UartConfig config;
 
         static const uint8_t COMMAND[];
         static const int COMMAND_SIZE = 8;
+        static const uint8_t SLAVE_ID = 0x01;
+        static const uint16_t REG_START = 0x0000;
+        static const uint16_t REG_COUNT = 30;
 
         static const int FRAME_SIZE = 65;
         static const int DATA_SIZE = 60;
@@ -34,6 +39,9 @@ class Lop2{
         bool sendcommand();
 
         bool receiveData(uint8_t* buffer);
+        // 发送命令并接收应答(带超时)，成功时 buffer 中为完整的 65 字节应答帧
+        ModbusStatus poll(uint8_t* buffer);
+        ModbusRtuMaster& modbus() { return *master; }
         bool validateFrame(uint8_t* buffer);
 
         void printReceivedData(const uint8_t* buffer);
@@ -0,0 +1,146 @@
+// modbus_poll_scheduler.cpp
+#include "modbus_poll_scheduler.h"
+#include <thread>
+
+ModbusPollScheduler::ModbusPollScheduler(ModbusRtuMaster &master)
+  : master(master), running(true)
+{
+    lastFrameEnd = Clock::now();
+    statsStart = lastFrameEnd;
+}
+
+int ModbusPollScheduler::addTask(uint8_t slave, uint8_t fc, uint16_t addr, uint16_t count,
+                                 int periodMs, PollHandler handler)
+{
+    // 周期用作除数(落后时跳过的周期数)和频率的分母，必须为正
+    if (periodMs <= 0) return -1;
+
+    Task task;
+    task.slave = slave;
+    task.fc = fc;
+    task.addr = addr;
+    task.count = count;
+    task.period = std::chrono::milliseconds(periodMs);
+    task.handler = handler;
+    task.release = Clock::now();
+    task.ok = 0;
+    task.failed = 0;
+    task.missed = 0;
+    tasks.push_back(task);
+    return int(tasks.size()) - 1;
+}
+
+void ModbusPollScheduler::run()
+{
+    // running 只由 stop() 清除，run() 开始前的 stop() 不会丢失
+    while (running) {
+        runOnce();
+    }
+}
+
+void ModbusPollScheduler::runOnce()
+{
+    if (tasks.empty()) return;
+
+    // 就绪任务中选截止时间(release + period)最早的
+    Clock::time_point now = Clock::now();
+    int best = -1;
+    Clock::time_point bestDeadline = Clock::time_point::max();
+    Clock::time_point nextRelease = Clock::time_point::max();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const Task &t = tasks[i];
+        if (t.release <= now) {
+            Clock::time_point deadline = t.release + t.period;
+            if (deadline < bestDeadline) {
+                bestDeadline = deadline;
+                best = int(i);
+            }
+        } else if (t.release < nextRelease) {
+            nextRelease = t.release;
+        }
+    }
+
+    if (best < 0) {
+        std::this_thread::sleep_until(nextRelease);
+        return;
+    }
+
+    // 上一帧结束后至少留出 3.5 字符静默
+    Clock::time_point earliest = lastFrameEnd + std::chrono::microseconds(master.frameGapUs());
+    if (earliest > now) {
+        std::this_thread::sleep_until(earliest);
+    }
+
+    execute(best, tasks[best]);
+}
+
+void ModbusPollScheduler::execute(int id, Task &task)
+{
+    uint16_t regs[ModbusRtuMaster::MAX_READ_REGS];
+    ModbusStatus st = (task.fc == ModbusRtuMaster::FC_READ_INPUT)
+        ? master.readInputRegisters(task.slave, task.addr, task.count, regs)
+        : master.readHoldingRegisters(task.slave, task.addr, task.count, regs);
+    lastFrameEnd = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (st == MODBUS_OK) {
+            ++task.ok;
+        } else {
+            ++task.failed;
+        }
+    }
+
+    PollResult result;
+    result.task = id;
+    result.status = st;
+    result.regs = regs;
+    result.count = task.count;
+    result.frame = master.lastResponse(result.frameLen);
+    result.rx = master.lastResponseTime();
+    if (task.handler) {
+        task.handler(result);
+    }
+
+    // 进入下一周期；落后超过一个周期时跳过错过的周期，不做追赶
+    task.release += task.period;
+    if (task.release + task.period < lastFrameEnd) {
+        Clock::duration behind = lastFrameEnd - task.release;
+        uint32_t skip = uint32_t(behind / task.period);
+        std::lock_guard<std::mutex> lock(statsMutex);
+        task.missed += skip;
+        task.release += task.period * skip;
+    }
+}
+
+std::vector<PollTaskStats> ModbusPollScheduler::stats() const
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    double elapsed = std::chrono::duration<double>(Clock::now() - statsStart).count();
+    std::vector<PollTaskStats> out;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const Task &t = tasks[i];
+        PollTaskStats s;
+        s.slave = t.slave;
+        s.addr = t.addr;
+        s.count = t.count;
+        s.requestedHz = 1.0 / std::chrono::duration<double>(t.period).count();
+        s.achievedHz = elapsed > 0 ? t.ok / elapsed : 0;
+        s.ok = t.ok;
+        s.failed = t.failed;
+        s.missed = t.missed;
+        out.push_back(s);
+    }
+    return out;
+}
+
+void ModbusPollScheduler::resetStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        tasks[i].ok = 0;
+        tasks[i].failed = 0;
+        tasks[i].missed = 0;
+    }
+    statsStart = Clock::now();
+}
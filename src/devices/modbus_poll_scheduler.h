@@ -0,0 +1,89 @@
+// modbus_poll_scheduler.h
+#ifndef _MODBUS_POLL_SCHEDULER_H
+#define _MODBUS_POLL_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "modbus_rtu_master.h"
+
+// 一次轮询的结果，指针仅在回调期间有效
+struct PollResult {
+    int             task;      // addTask() 返回的编号
+    ModbusStatus    status;
+    const uint16_t *regs;      // 解码后的寄存器
+    uint16_t        count;
+    const uint8_t  *frame;     // 原始应答帧(含地址和 CRC)
+    int             frameLen;
+    RxTimestamp     rx;        // 应答到达时间
+};
+
+// 每个轮询任务的统计
+struct PollTaskStats {
+    uint8_t  slave;
+    uint16_t addr;
+    uint16_t count;
+    double   requestedHz;
+    double   achievedHz;       // 成功应答的实际频率
+    uint32_t ok;
+    uint32_t failed;
+    uint32_t missed;           // 来不及执行而跳过的周期
+};
+
+/*
+ * 半双工总线上的多从站轮询调度器：
+ * 每个任务 (从站, 寄存器块, 周期) 在周期开始时就绪，截止时间为周期结束，
+ * 总是先执行截止时间最早的就绪任务(EDF)，请求之间只留出波特率对应的 3.5 字符帧间隔，
+ * 总线不再被固定延时空占。
+ */
+class ModbusPollScheduler {
+    public:
+        typedef std::function<void(const PollResult &)> PollHandler;
+
+        explicit ModbusPollScheduler(ModbusRtuMaster &master);
+
+        // fc 为 FC03 或 FC04，返回任务编号，periodMs 不为正时返回 -1；需在 run() 之前添加
+        int addTask(uint8_t slave, uint8_t fc, uint16_t addr, uint16_t count,
+                    int periodMs, PollHandler handler);
+
+        // 阻塞运行，直到 stop()；stop() 已先调用时立即返回
+        void run();
+        // 可在任意线程调用，run() 开始之前调用也有效
+        void stop() { running = false; }
+
+        // 执行一个到期任务，没有到期任务时睡到最近的周期开始
+        void runOnce();
+
+        std::vector<PollTaskStats> stats() const;
+        void resetStats();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Task {
+            uint8_t  slave;
+            uint8_t  fc;
+            uint16_t addr;
+            uint16_t count;
+            Clock::duration period;
+            PollHandler handler;
+
+            Clock::time_point release;   // 本周期开始
+            uint32_t ok;
+            uint32_t failed;
+            uint32_t missed;
+        };
+
+        ModbusRtuMaster &master;
+        std::vector<Task> tasks;
+        std::atomic<bool> running;
+        mutable std::mutex statsMutex;   // 统计可在其它线程读取
+        Clock::time_point lastFrameEnd;
+        Clock::time_point statsStart;
+
+        void execute(int id, Task &task);
+};
+
+#endif
@@ -0,0 +1,186 @@
+// modbus_rtu_master.cpp
+#include "modbus_rtu_master.h"
+#include "crc16.h"
+#include <cstring>
+
+const char *modbusStatusString(ModbusStatus status)
+{
+    switch (status) {
+    case MODBUS_OK:           return "ok";
+    case MODBUS_TIMEOUT:      return "timeout";
+    case MODBUS_CRC_ERROR:    return "crc error";
+    case MODBUS_EXCEPTION:    return "exception response";
+    case MODBUS_BAD_RESPONSE: return "bad response";
+    case MODBUS_IO_ERROR:     return "io error";
+    }
+    return "unknown";
+}
+
+ModbusRtuMaster::ModbusRtuMaster(LinuxUart &uart, int timeoutMs)
+  : uart(uart), timeoutMs(timeoutMs), respLen(0), exceptionCode(0)
+{
+    respRx.monoNs = 0;
+    respRx.realNs = 0;
+    updateTiming();
+}
+
+void ModbusRtuMaster::updateTiming()
+{
+    const UartConfig &cfg = uart.getConfig();
+    int baudRate = cfg.baudRate;
+    // 起始位 + 数据位 + 校验位 + 停止位
+    charUs = (cfg.bitsPerChar() * 1000000 + baudRate - 1) / baudRate;
+    // 规范：波特率高于 19200 时帧间隔固定为 1.75ms
+    gapUs = baudRate > 19200 ? 1750 : (charUs * 7 + 1) / 2;
+}
+
+int ModbusRtuMaster::buildReadRequest(uint8_t *req, uint8_t slave, uint8_t fc, uint16_t addr, uint16_t count)
+{
+    req[0] = slave;
+    req[1] = fc;
+    req[2] = addr >> 8;
+    req[3] = addr & 0xFF;
+    req[4] = count >> 8;
+    req[5] = count & 0xFF;
+    return 8;
+}
+
+bool ModbusRtuMaster::sendRequest(uint8_t *req, int len)
+{
+    // CRC 低字节在前
+    uint16_t crc = crc16_modbus(req, len - 2);
+    req[len - 2] = crc & 0xFF;
+    req[len - 1] = crc >> 8;
+    return uart.writeData(req, len) == len;
+}
+
+int ModbusRtuMaster::readResponse(uint8_t *buf, int cap, int expectLen)
+{
+    // 总期限：应答超时 + 已知长度的整帧传输时间
+    int64_t frameUs = int64_t(timeoutMs) * 1000 + int64_t(expectLen > 0 ? expectLen : 0) * charUs;
+    int64_t deadlineNs = rxTimestampNow().monoNs + frameUs * 1000;
+    int n = 0;
+    while (n < cap) {
+        // 首字节和已知长度的应答等到总期限；tty 驱动成批交付，UART FIFO 要等约 4 字符的接收超时
+        // 才交出尾部字节，用户态测到的 3.5 字符静默不可靠，只用于判断未知长度应答的结束
+        int waitUs = gapUs;
+        if (n == 0 || expectLen > 0) {
+            int64_t leftNs = deadlineNs - rxTimestampNow().monoNs;
+            if (leftNs <= 0) break;
+            waitUs = int((leftNs + 999) / 1000);
+        }
+        int r = uart.waitReadable(waitUs);
+        if (r < 0) return -1;
+        if (r == 0) break;
+
+        // 可读却读不到数据：挂断或出错(POLLHUP/POLLERR)，不再重试
+        int len = uart.readData(buf + n, cap - n);
+        if (len <= 0) return -1;
+        n += len;
+
+        if (expectLen > 0 && n >= expectLen) break;
+        // 异常应答固定 5 字节
+        if (n >= 5 && (buf[1] & 0x80)) break;
+    }
+    return n;
+}
+
+ModbusStatus ModbusRtuMaster::transact(uint8_t *req, int reqLen, int expectLen)
+{
+    respLen = 0;
+    exceptionCode = 0;
+
+    uart.flushInput();
+    if (!sendRequest(req, reqLen)) return MODBUS_IO_ERROR;
+
+    int n = readResponse(resp, MAX_ADU, expectLen);
+    if (n < 0) return MODBUS_IO_ERROR;
+    if (n == 0) return MODBUS_TIMEOUT;
+    respLen = n;
+    respRx = uart.lastReadTime();
+    // 帧间超时内没收齐：按超时处理，不去校验半帧的 CRC（5 字节异常应答除外）
+    bool exception = n == 5 && (resp[1] & 0x80);
+    if (expectLen > 0 && n < expectLen && !exception) return MODBUS_TIMEOUT;
+    if (n < 5) return MODBUS_BAD_RESPONSE;
+
+    uint16_t crc = crc16_modbus(resp, n - 2);
+    if ((resp[n - 2] | (resp[n - 1] << 8)) != crc) return MODBUS_CRC_ERROR;
+
+    if (resp[0] != req[0]) return MODBUS_BAD_RESPONSE;
+    if (resp[1] == (req[1] | 0x80)) {
+        exceptionCode = resp[2];
+        return MODBUS_EXCEPTION;
+    }
+    if (resp[1] != req[1]) return MODBUS_BAD_RESPONSE;
+    if (expectLen > 0 && n != expectLen) return MODBUS_BAD_RESPONSE;
+    return MODBUS_OK;
+}
+
+ModbusStatus ModbusRtuMaster::readRegisters(uint8_t slave, uint8_t fc, uint16_t addr, uint16_t count, uint16_t *regs)
+{
+    if (count == 0 || count > MAX_READ_REGS) return MODBUS_BAD_RESPONSE;
+
+    uint8_t req[8];
+    buildReadRequest(req, slave, fc, addr, count);
+
+    // 地址 + 功能码 + 字节数 + 数据 + CRC
+    ModbusStatus st = transact(req, sizeof(req), 5 + 2 * count);
+    if (st != MODBUS_OK) return st;
+    if (resp[2] != 2 * count) return MODBUS_BAD_RESPONSE;
+
+    for (int i = 0; i < count; ++i) {
+        regs[i] = uint16_t(resp[3 + 2 * i] << 8) | resp[4 + 2 * i];
+    }
+    return MODBUS_OK;
+}
+
+ModbusStatus ModbusRtuMaster::readHoldingRegisters(uint8_t slave, uint16_t addr, uint16_t count, uint16_t *regs)
+{
+    return readRegisters(slave, FC_READ_HOLDING, addr, count, regs);
+}
+
+ModbusStatus ModbusRtuMaster::readInputRegisters(uint8_t slave, uint16_t addr, uint16_t count, uint16_t *regs)
+{
+    return readRegisters(slave, FC_READ_INPUT, addr, count, regs);
+}
+
+ModbusStatus ModbusRtuMaster::writeSingleRegister(uint8_t slave, uint16_t addr, uint16_t value)
+{
+    uint8_t req[8];
+    req[0] = slave;
+    req[1] = FC_WRITE_SINGLE;
+    req[2] = addr >> 8;
+    req[3] = addr & 0xFF;
+    req[4] = value >> 8;
+    req[5] = value & 0xFF;
+
+    // 正常应答为请求的原样回显
+    ModbusStatus st = transact(req, sizeof(req), sizeof(req));
+    if (st != MODBUS_OK) return st;
+    if (memcmp(resp, req, sizeof(req)) != 0) return MODBUS_BAD_RESPONSE;
+    return MODBUS_OK;
+}
+
+ModbusStatus ModbusRtuMaster::writeMultipleRegisters(uint8_t slave, uint16_t addr, uint16_t count, const uint16_t *values)
+{
+    if (count == 0 || count > MAX_WRITE_REGS) return MODBUS_BAD_RESPONSE;
+
+    uint8_t req[MAX_ADU];
+    req[0] = slave;
+    req[1] = FC_WRITE_MULTIPLE;
+    req[2] = addr >> 8;
+    req[3] = addr & 0xFF;
+    req[4] = count >> 8;
+    req[5] = count & 0xFF;
+    req[6] = 2 * count;
+    for (int i = 0; i < count; ++i) {
+        req[7 + 2 * i] = values[i] >> 8;
+        req[8 + 2 * i] = values[i] & 0xFF;
+    }
+
+    // 应答: 地址 + 功能码 + 起始地址 + 数量 + CRC
+    ModbusStatus st = transact(req, 9 + 2 * count, 8);
+    if (st != MODBUS_OK) return st;
+    if (memcmp(resp + 2, req + 2, 4) != 0) return MODBUS_BAD_RESPONSE;
+    return MODBUS_OK;
+}
@@ -0,0 +1,82 @@
+// modbus_rtu_master.h
+#ifndef _MODBUS_RTU_MASTER_H
+#define _MODBUS_RTU_MASTER_H
+
+#include <stdint.h>
+#include "linux_uart.h"
+
+enum ModbusStatus {
+    MODBUS_OK = 0,
+    MODBUS_TIMEOUT,        // 超时无应答或应答不完整
+    MODBUS_CRC_ERROR,      // CRC 错误
+    MODBUS_EXCEPTION,      // 从站返回异常应答，见 lastException()
+    MODBUS_BAD_RESPONSE,   // 应答地址/功能码/长度不符
+    MODBUS_IO_ERROR        // 串口读写失败
+};
+
+const char *modbusStatusString(ModbusStatus status);
+
+/*
+ * 通用 Modbus RTU 主站：
+ *  - 组 FC03/FC04/FC06/FC16 请求，任意从站、寄存器起始地址和数量
+ *  - 应答超时可配置，不会因从站掉线而一直阻塞
+ *  - 已知应答长度时收满或到总期限才返回，未知长度时以 3.5 字符静默间隔判断帧结束
+ */
+class ModbusRtuMaster {
+    public:
+        static const int MAX_ADU = 256;
+        static const int MAX_READ_REGS = 125;
+        static const int MAX_WRITE_REGS = 123;
+
+        static const uint8_t FC_READ_HOLDING = 0x03;
+        static const uint8_t FC_READ_INPUT = 0x04;
+        static const uint8_t FC_WRITE_SINGLE = 0x06;
+        static const uint8_t FC_WRITE_MULTIPLE = 0x10;
+
+        ModbusRtuMaster(LinuxUart &uart, int timeoutMs = 500);
+
+        void setTimeout(int ms) { timeoutMs = ms; }
+        int getTimeout() const { return timeoutMs; }
+        // 按串口当前的波特率和字符格式重新计算字符时间，串口重新配置后需调用
+        void updateTiming();
+
+        // 单字符时间、帧间 3.5 字符静默时间(微秒)
+        int charTimeUs() const { return charUs; }
+        int frameGapUs() const { return gapUs; }
+
+        ModbusStatus readHoldingRegisters(uint8_t slave, uint16_t addr, uint16_t count, uint16_t *regs);
+        ModbusStatus readInputRegisters(uint8_t slave, uint16_t addr, uint16_t count, uint16_t *regs);
+        ModbusStatus writeSingleRegister(uint8_t slave, uint16_t addr, uint16_t value);
+        ModbusStatus writeMultipleRegisters(uint8_t slave, uint16_t addr, uint16_t count, const uint16_t *values);
+
+        // 组读寄存器请求(FC03/FC04)，返回请求长度
+        static int buildReadRequest(uint8_t *req, uint8_t slave, uint8_t fc, uint16_t addr, uint16_t count);
+
+        // 发送已组好的请求(末尾 CRC 由本函数追加)
+        bool sendRequest(uint8_t *req, int len);
+        // 接收一帧应答，expectLen>0 时收满或到总期限(应答超时 + 整帧传输时间)返回，
+        // 否则以 3.5 字符静默判断结束；返回收到的字节数，超时返回 0，出错或挂断返回 -1
+        int readResponse(uint8_t *buf, int cap, int expectLen);
+
+        // 最近一次应答的原始报文(含地址和 CRC)
+        const uint8_t *lastResponse(int &len) const { len = respLen; return resp; }
+        uint8_t lastException() const { return exceptionCode; }
+        // 最近一次应答最后一块数据被读到的时间(而非解析完成的时间)
+        const RxTimestamp &lastResponseTime() const { return respRx; }
+
+    private:
+        LinuxUart &uart;
+        int timeoutMs;
+        int charUs;
+        int gapUs;
+
+        uint8_t resp[MAX_ADU];
+        int respLen;
+        uint8_t exceptionCode;
+        RxTimestamp respRx;
+
+        ModbusStatus transact(uint8_t *req, int reqLen, int expectLen);
+        ModbusStatus readRegisters(uint8_t slave, uint8_t fc, uint16_t addr, uint16_t count, uint16_t *regs);
+};
+
+#endif
@@ -0,0 +1,145 @@
+// profile_ports.cpp
+#include "profile_ports.h"
+#include <iostream>
+
+ProfilePorts::ProfilePorts(const DeviceProfile &profile, const std::vector<DecodeProgram> &programs)
+  : profile(profile), programs(programs)
+{
+}
+
+ProfilePorts::~ProfilePorts()
+{
+    stop();
+    join();
+}
+
+bool ProfilePorts::open()
+{
+    for (const PortSpec &spec : profile.ports) {
+        std::unique_ptr<LinuxUart> uart(new LinuxUart(spec.device, spec.uart));
+        if (!uart->configure(spec.uart)) {
+            std::cerr << "Failed to initialize " << spec.device << std::endl;
+            return false;
+        }
+
+        if (spec.protocol == PROTOCOL_FAF5) {
+            std::unique_ptr<FaF5Port> port(new FaF5Port);
+            port->spec = &spec;
+            port->uart = std::move(uart);
+            for (int frame : spec.frames) {
+                if (!port->parser.addFrameLength(uint16_t(profile.frames[frame].length))) {
+                    std::cerr << spec.device << ": cannot decode frame " << profile.frames[frame].table
+                              << " (at most " << FaF5Parser::MAX_LENGTHS << " frame lengths per port)" << std::endl;
+                    return false;
+                }
+            }
+            faf5Ports.push_back(std::move(port));
+        } else {
+            std::unique_ptr<ModbusPort> port(new ModbusPort);
+            port->spec = &spec;
+            port->uart = std::move(uart);
+            port->master.reset(new ModbusRtuMaster(*port->uart, spec.timeoutMs));
+            port->master->updateTiming();
+            port->scheduler.reset(new ModbusPollScheduler(*port->master));
+            for (const PollSpec &poll : spec.polls) {
+                const PollSpec *p = &poll;
+                int task = port->scheduler->addTask(poll.slave, poll.function, poll.address, poll.count,
+                                                    poll.periodMs,
+                                                    [this, p](const PollResult &result) { onPoll(*p, result); });
+                if (task < 0) {
+                    std::cerr << spec.device << ": invalid poll period " << poll.periodMs << " ms" << std::endl;
+                    return false;
+                }
+            }
+            modbusPorts.push_back(std::move(port));
+        }
+    }
+    return true;
+}
+
+void ProfilePorts::start(FrameHandler frameHandler)
+{
+    handler = frameHandler;
+    if (!faf5Ports.empty()) {
+        for (auto &port : faf5Ports) {
+            FaF5Port *p = port.get();
+            reactor.addPort(*p->uart, [this, p](const uint8_t *data, int len, const RxTimestamp &rx) {
+                onFaF5Data(*p, data, len, rx);
+            });
+        }
+        threads.push_back(std::thread(&SerialReactor::run, &reactor));
+    }
+    for (auto &port : modbusPorts) {
+        if (!port->spec->polls.empty()) {
+            threads.push_back(std::thread(&ModbusPollScheduler::run, port->scheduler.get()));
+        }
+    }
+}
+
+void ProfilePorts::stop()
+{
+    reactor.stop();
+    for (auto &port : modbusPorts) port->scheduler->stop();
+}
+
+void ProfilePorts::join()
+{
+    for (std::thread &t : threads) {
+        if (t.joinable()) t.join();
+    }
+    threads.clear();
+}
+
+std::vector<PollTaskStats> ProfilePorts::pollStats() const
+{
+    std::vector<PollTaskStats> all;
+    for (const auto &port : modbusPorts) {
+        std::vector<PollTaskStats> st = port->scheduler->stats();
+        all.insert(all.end(), st.begin(), st.end());
+    }
+    return all;
+}
+
+// 分帧后按帧长选解码程序，端口上的帧长各不相同(描述文件加载时已校验)
+void ProfilePorts::onFaF5Data(FaF5Port &port, const uint8_t *data, int len, const RxTimestamp &rx)
+{
+    DecodedFrame decoded;
+    while (len > 0) {
+        int n = int(port.parser.feed(data, uint32_t(len), rx));
+        data += n;
+        len -= n;
+
+        int frameLen = 0;
+        const uint8_t *frame;
+        bool released = false;
+        while ((frame = port.parser.next(frameLen)) != nullptr) {
+            for (int id : port.spec->frames) {
+                if (programs[id].length() == frameLen) {
+                    programs[id].decode(frame, port.parser.frameTime(), decoded);
+                    handler(decoded);
+                    break;
+                }
+            }
+            port.parser.release();
+            released = true;
+        }
+        // 缓冲已满且取不出帧时丢弃本次剩余数据，避免死循环
+        if (n == 0 && !released) break;
+    }
+}
+
+void ProfilePorts::onPoll(const PollSpec &poll, const PollResult &result)
+{
+    if (result.status != MODBUS_OK) {
+        std::cerr << "Poll slave " << int(poll.slave) << " failed: " << modbusStatusString(result.status) << std::endl;
+        return;
+    }
+    const DecodeProgram &program = programs[poll.frame];
+    if (result.frameLen != program.length()) {
+        std::cerr << "Poll slave " << int(poll.slave) << ": unexpected frame length " << result.frameLen << std::endl;
+        return;
+    }
+    DecodedFrame decoded;
+    program.decode(result.frame, result.rx, decoded);
+    handler(decoded);
+}
@@ -0,0 +1,67 @@
+// profile_ports.h
+#ifndef _PROFILE_PORTS_H
+#define _PROFILE_PORTS_H
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "linux_uart.h"
+#include "serial_reactor.h"
+#include "faf5_parser.h"
+#include "modbus_rtu_master.h"
+#include "modbus_poll_scheduler.h"
+#include "device_profile.h"
+#include "decode_program.h"
+
+/*
+ * 按设备描述文件打开全部串口并收帧：
+ *   FA F5 端口共用一个 SerialReactor 线程，按帧长找到对应的解码程序；
+ *   每个 Modbus RTU 端口一个 ModbusPollScheduler 线程，应答按轮询任务指定的帧解码。
+ * 每解码出一帧调用一次 handler(在收帧线程中，DecodedFrame 仅在回调期间有效，需要时按值拷贝)。
+ */
+class ProfilePorts
+{
+    public:
+        typedef std::function<void(const DecodedFrame &)> FrameHandler;
+
+        // profile 与 programs 需在本对象存续期间有效
+        ProfilePorts(const DeviceProfile &profile, const std::vector<DecodeProgram> &programs);
+        ~ProfilePorts();
+
+        // 按描述文件配置全部串口，任一失败返回 false
+        bool open();
+        // 启动收帧线程
+        void start(FrameHandler handler);
+        void stop();
+        void join();
+
+        // 各 Modbus 端口的轮询统计
+        std::vector<PollTaskStats> pollStats() const;
+
+    private:
+        struct FaF5Port {
+            const PortSpec *spec;
+            std::unique_ptr<LinuxUart> uart;
+            FaF5Parser parser;
+        };
+        struct ModbusPort {
+            const PortSpec *spec;
+            std::unique_ptr<LinuxUart> uart;
+            std::unique_ptr<ModbusRtuMaster> master;
+            std::unique_ptr<ModbusPollScheduler> scheduler;
+        };
+
+        const DeviceProfile &profile;
+        const std::vector<DecodeProgram> &programs;
+        std::vector<std::unique_ptr<FaF5Port>> faf5Ports;
+        std::vector<std::unique_ptr<ModbusPort>> modbusPorts;
+        SerialReactor reactor;
+        std::vector<std::thread> threads;
+        FrameHandler handler;
+
+        void onFaF5Data(FaF5Port &port, const uint8_t *data, int len, const RxTimestamp &rx);
+        void onPoll(const PollSpec &poll, const PollResult &result);
+};
+
+#endif
@@ -8,22 +8,32 @@
 #include <unistd.h>
 #include <string.h>
 #include <termios.h>
+#include <poll.h>
+#include <time.h>
 #include "linux_uart.h"
+#include "uart_termios2.h"
 
 
 LinuxUart::LinuxUart(const string &deviceName, int baudRate)
 {
-    fd = open(deviceName.c_str(),O_RDWR | O_NOCTTY);
-    if(fd < 0){
-        fprintf(stderr,"Fail to open %s,err:%s\n",deviceName.c_str(),strerror(errno));
+    lastRx = rxTimestampNow();
+    openDevice(deviceName);
+
+    bool ok = defaultInit(baudRate);
+    if(!ok){
+        fprintf(stderr,"Fail to init baudRate:%d\n",baudRate);
         exit(EXIT_FAILURE);
     }
+}
 
-    printf("open %s success \n",deviceName.c_str());
+LinuxUart::LinuxUart(const string &deviceName, const UartConfig &config)
+{
+    lastRx = rxTimestampNow();
+    openDevice(deviceName);
 
-    bool ok = defaultInit(baudRate);
+    bool ok = configure(config);
     if(!ok){
-        fprintf(stderr,"Fail to init baudRate:%d\n",baudRate);
+        fprintf(stderr,"Fail to init baudRate:%d\n",config.baudRate);
         exit(EXIT_FAILURE);
     }
 }
@@ -33,67 +43,53 @@ LinuxUart::~LinuxUart()
     close(fd);
 }
 
-bool LinuxUart::defaultInit(int baudRate)
+void LinuxUart::openDevice(const string &deviceName)
 {
-    int ret;
-    int err;
-    struct termios tio;
-    if (tcgetattr(fd, &tio) != 0) {
-        std::cerr << "Failed to get serial port attributes" << std::endl;
-        close(fd);
-        return -1;
+    fd = open(deviceName.c_str(),O_RDWR | O_NOCTTY);
+    if(fd < 0){
+        fprintf(stderr,"Fail to open %s,err:%s\n",deviceName.c_str(),strerror(errno));
+        exit(EXIT_FAILURE);
     }
 
-    // 清空各类模式
-    tio.c_iflag = 0;
-    tio.c_oflag = 0;
-    tio.c_lflag = 0;
-    tio.c_cflag &= ~CSIZE;
-    tio.c_cflag |= CLOCAL | CREAD; // 本地连接、允许接收
-    
-    // 设置波特率
-    switch (baudRate){
-    case 4800:
-        cfsetispeed(&tio, B4800);
-        cfsetospeed(&tio, B4800);
-        break;
-    case 9600:
-        cfsetispeed(&tio, B9600);
-        cfsetospeed(&tio, B9600);
-        break;
-    case 57600:
-        cfsetispeed(&tio, B57600);
-        cfsetospeed(&tio, B57600);
-        break;
-    case 115200:
-        cfsetispeed(&tio, B115200);
-        cfsetospeed(&tio, B115200);
-        break;
-    default:
-        fprintf(stderr, "The baudrate:%d is not support\n", baudRate);
-        return false;
-    }
+    printf("open %s success \n",deviceName.c_str());
+}
 
-    // 设置数据位为8bit  
-    tio.c_cflag |= CS8;
-    // 启用奇偶校验并设置为奇校验
-    tio.c_cflag |= PARENB;  // 启用奇偶校验
-    tio.c_cflag |= PARODD;  // 设置为奇校验
-    tio.c_cflag &= ~CSTOPB; // 1位停止位
+/**
+ * @brief 按默认格式 8 数据位、奇校验、1 停止位初始化
+ * 
+ * @param baudRate 
+ * @return true 
+ * @return false 
+ */
+bool LinuxUart::defaultInit(int baudRate)
+{
+    return configure(UartConfig(baudRate));
+}
 
-    // 设置等待时间和最小接收字符 
-    tio.c_cc[VTIME] = 0;
-    tio.c_cc[VMIN] = 1;
+/**
+ * @brief 按配置初始化串口：任意波特率、校验位、停止位，以及可选的内核 RS-485 方向控制
+ * 
+ * @param cfg 
+ * @return true 
+ * @return false 
+ */
+bool LinuxUart::configure(const UartConfig &cfg)
+{
+    if(cfg.baudRate <= 0){
+        fprintf(stderr, "The baudrate:%d is not support\n", cfg.baudRate);
+        return false;
+    }
 
-    // 刷新串口:处理未接收字符 
-    tcflush(fd, TCIOFLUSH);
+    if(!uartApplyTermios2(fd, cfg)){
+        return false;
+    }
 
-    // 设置参数
-    err = tcsetattr(fd, TCSANOW, &tio);//TCSANOW的意思就是配置立即生效
-    if (err){
-        fprintf(stderr, "Fail to tcsetattr,err:%s\n", strerror(errno));
+    // 未启用时不去动驱动/设备树里已有的 RS-485 设置
+    if(cfg.rs485 && !uartApplyRs485(fd, cfg)){
         return false;
     }
+
+    config = cfg;
     return true;
 }
 
@@ -109,10 +105,18 @@ int LinuxUart::readData(uint8_t *buf, uint32_t size)
     int len;
     len = read(fd,buf,size);
     if(len < 0){
+        // 非阻塞模式下暂无数据，不算错误
+        if(errno == EAGAIN || errno == EWOULDBLOCK){
+            return 0;
+        }
         fprintf(stderr, "Fail to readData,err:%s\n", strerror(errno));
         return -1;
     }
 
+    // 读调用返回即打时间戳，不受后续排队、解析延迟影响
+    if(len > 0){
+        lastRx = rxTimestampNow();
+    }
     return len;
 }
 
@@ -150,3 +154,64 @@ int LinuxUart::readFixLenData(uint8_t *buf, uint32_t fixLen)
 
     return count != fixLen?-1:fixLen;
 }
+
+/**
+ * @brief 设置串口为非阻塞模式(O_NONBLOCK),供 epoll 等多路复用使用
+ * 
+ * @param enable 
+ * @return true 
+ * @return false 
+ */
+bool LinuxUart::setNonBlocking(bool enable)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if(flags < 0){
+        fprintf(stderr, "Fail to fcntl F_GETFL,err:%s\n", strerror(errno));
+        return false;
+    }
+
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    if(fcntl(fd, F_SETFL, flags) < 0){
+        fprintf(stderr, "Fail to fcntl F_SETFL,err:%s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 等待串口可读,返回 1 可读, 0 超时, -1 出错
+ * 
+ * @param timeoutUs 超时时间(微秒), <0 表示一直等待
+ * @return int 
+ */
+int LinuxUart::waitReadable(int timeoutUs)
+{
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    struct timespec ts;
+    ts.tv_sec = timeoutUs / 1000000;
+    ts.tv_nsec = (timeoutUs % 1000000) * 1000L;
+
+    int ret;
+    do {
+        ret = ppoll(&pfd, 1, timeoutUs < 0 ? nullptr : &ts, nullptr);
+    } while(ret < 0 && errno == EINTR);
+
+    if(ret < 0){
+        fprintf(stderr, "Fail to ppoll,err:%s\n", strerror(errno));
+        return -1;
+    }
+    return ret > 0 ? 1 : 0;
+}
+
+/**
+ * @brief 丢弃接收缓冲中尚未读取的数据
+ * 
+ */
+void LinuxUart::flushInput()
+{
+    tcflush(fd, TCIFLUSH);
+}
@@ -3,19 +3,56 @@
 
 #include <iostream>
 #include <stdint.h>
+#include "rx_timestamp.h"
 using namespace std;
 
+enum UartParity { PARITY_NONE, PARITY_ODD, PARITY_EVEN };
+
+// 串口参数，默认 8 数据位、奇校验、1 停止位
+struct UartConfig
+{
+    int baudRate;               // 任意波特率(termios2/BOTHER)，如 230400、460800
+    int dataBits;
+    UartParity parity;
+    int stopBits;
+
+    bool rs485;                 // 启用内核 RS-485 模式，由驱动控制 RTS 收发方向
+    bool rtsOnSend;             // 发送时 RTS 为高电平(否则发送后为高)
+    int delayRtsBeforeSendMs;
+    int delayRtsAfterSendMs;
+
+    UartConfig(int baudRate = 9600)
+      : baudRate(baudRate), dataBits(8), parity(PARITY_ODD), stopBits(1),
+        rs485(false), rtsOnSend(true), delayRtsBeforeSendMs(0), delayRtsAfterSendMs(0) {}
+
+    // 每个字符在线路上的位数(含起始位)
+    int bitsPerChar() const { return 1 + dataBits + (parity != PARITY_NONE ? 1 : 0) + stopBits; }
+};
+
 class LinuxUart
 {
     public:
         LinuxUart(const string &deviceName,int baudRate = 9600);
+        LinuxUart(const string &deviceName,const UartConfig &config);
         ~LinuxUart();
         bool defaultInit(int baudRate);
+        bool configure(const UartConfig &config);
+        const UartConfig &getConfig() const { return config; }
         int readData(uint8_t * buf,uint32_t size);
         int writeData(const uint8_t * buf,uint32_t size);
         int readFixLenData(uint8_t * buf,uint32_t fixLen);
+        bool setNonBlocking(bool enable);
+        int waitReadable(int timeoutUs);
+        void flushInput();
+        int getFd() const { return fd; }
+        // 最近一次成功读到数据的时间
+        const RxTimestamp &lastReadTime() const { return lastRx; }
     private:
         int fd;
+        UartConfig config;
+        RxTimestamp lastRx;
+
+        void openDevice(const string &deviceName);
 };
 
 
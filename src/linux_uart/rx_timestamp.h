@@ -0,0 +1,27 @@
+#ifndef _RX_TIMESTAMP_H
+#define _RX_TIMESTAMP_H
+
+#include <stdint.h>
+#include <time.h>
+
+// 串口读到数据那一刻的时间戳(纳秒)：
+// monoNs 用于不同端口之间的精确先后/间隔比较，realNs 为对应的墙上时间
+struct RxTimestamp
+{
+    int64_t monoNs;
+    int64_t realNs;
+};
+
+inline RxTimestamp rxTimestampNow()
+{
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+
+    RxTimestamp ts;
+    ts.monoNs = int64_t(mono.tv_sec) * 1000000000LL + mono.tv_nsec;
+    ts.realNs = int64_t(real.tv_sec) * 1000000000LL + real.tv_nsec;
+    return ts;
+}
+
+#endif
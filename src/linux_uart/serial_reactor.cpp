@@ -0,0 +1,130 @@
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include "serial_reactor.h"
+
+// epoll_event.data.u64 中用来标识唤醒 fd 的值
+static const uint64_t WAKE_TAG = ~0ULL;
+
+SerialReactor::SerialReactor() : running(true)
+{
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if(epfd < 0){
+        fprintf(stderr,"Fail to epoll_create1,err:%s\n",strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(wakefd < 0){
+        fprintf(stderr,"Fail to eventfd,err:%s\n",strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_TAG;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+}
+
+SerialReactor::~SerialReactor()
+{
+    close(wakefd);
+    close(epfd);
+}
+
+bool SerialReactor::addPort(LinuxUart &uart, DataHandler handler)
+{
+    if(!uart.setNonBlocking(true)){
+        return false;
+    }
+
+    Port port;
+    port.uart = &uart;
+    port.handler = handler;
+    ports.push_back(port);
+
+    // data 中存端口下标，ports 扩容后指针会失效
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = ports.size() - 1;
+    if(epoll_ctl(epfd, EPOLL_CTL_ADD, uart.getFd(), &ev) < 0){
+        fprintf(stderr,"Fail to epoll_ctl ADD,err:%s\n",strerror(errno));
+        ports.pop_back();
+        return false;
+    }
+    return true;
+}
+
+void SerialReactor::run()
+{
+    struct epoll_event events[MAX_EVENTS];
+
+    while(running.load()){
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            fprintf(stderr,"Fail to epoll_wait,err:%s\n",strerror(errno));
+            break;
+        }
+
+        for(int i = 0; i < n; ++i){
+            if(events[i].data.u64 == WAKE_TAG){
+                uint64_t v;
+                ssize_t r = read(wakefd, &v, sizeof(v));
+                (void)r;
+                continue;
+            }
+
+            Port &port = ports[events[i].data.u64];
+            if(events[i].events & (EPOLLERR | EPOLLHUP)){
+                removePort(port, "error");
+                continue;
+            }
+            if(events[i].events & EPOLLIN){
+                onReadable(port);
+            }
+        }
+    }
+    running = false;
+}
+
+void SerialReactor::stop()
+{
+    running = false;
+    uint64_t v = 1;
+    ssize_t r = write(wakefd, &v, sizeof(v));
+    (void)r;
+}
+
+// 一次把内核缓冲读空，每块数据立即交给分帧器
+void SerialReactor::onReadable(Port &port)
+{
+    uint8_t buf[READ_CHUNK];
+    while(true){
+        int len = port.uart->readData(buf, sizeof(buf));
+        if(len < 0){
+            // EIO 等读错误(如 USB 转串口掉线)不会自行消失，fd 一直可读
+            removePort(port, "read error");
+            break;
+        }
+        if(len == 0){
+            break;
+        }
+        port.handler(buf, len, port.uart->lastReadTime());
+        if(len < READ_CHUNK){
+            break;
+        }
+    }
+}
+
+void SerialReactor::removePort(Port &port, const char *reason)
+{
+    fprintf(stderr,"Serial fd %d %s, removed from reactor\n",port.uart->getFd(),reason);
+    epoll_ctl(epfd, EPOLL_CTL_DEL, port.uart->getFd(), nullptr);
+}
@@ -0,0 +1,50 @@
+#ifndef _SERIAL_REACTOR_H
+#define _SERIAL_REACTOR_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <stdint.h>
+#include "linux_uart.h"
+
+/*
+ * 基于 epoll 的多串口反应器：
+ * 一个线程同时监听任意数量的串口 fd(非阻塞)，
+ * 数据一到就交给对应端口的回调(分帧器)处理，不再需要每个端口一个阻塞线程。
+ */
+class SerialReactor
+{
+    public:
+        // 收到数据的回调: data/len 仅在回调期间有效，rx 为读到这块数据的时间
+        typedef std::function<void(const uint8_t *data, int len, const RxTimestamp &rx)> DataHandler;
+
+        SerialReactor();
+        ~SerialReactor();
+
+        // 需在 run() 之前调用，串口会被切换为 O_NONBLOCK
+        bool addPort(LinuxUart &uart, DataHandler handler);
+        // 阻塞运行事件循环，直到 stop() 被调用；stop() 已先调用时立即返回
+        void run();
+        // 可在任意线程调用，run() 开始之前调用也有效
+        void stop();
+
+    private:
+        struct Port {
+            LinuxUart *uart;
+            DataHandler handler;
+        };
+
+        static const int MAX_EVENTS = 16;
+        static const int READ_CHUNK = 64;
+
+        int epfd;
+        int wakefd;
+        std::atomic<bool> running;      // 构造时为 true，只由 stop() 和出错退出清除
+        std::vector<Port> ports;
+
+        void onReadable(Port &port);
+        // 端口出错时移出 epoll，不再处理(水平触发下不移出会一直被唤醒)
+        void removePort(Port &port, const char *reason);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include "uart_termios2.h"
+
+bool uartApplyTermios2(int fd, const UartConfig &cfg)
+{
+    struct termios2 tio;
+    if(ioctl(fd, TCGETS2, &tio) < 0){
+        fprintf(stderr, "Fail to TCGETS2,err:%s\n", strerror(errno));
+        return false;
+    }
+
+    // 清空各类模式
+    tio.c_iflag = 0;
+    tio.c_oflag = 0;
+    tio.c_lflag = 0;
+    tio.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB | CRTSCTS | CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= CLOCAL | CREAD; // 本地连接、允许接收
+
+    // 任意波特率：BOTHER 表示直接使用 c_ispeed/c_ospeed
+    tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tio.c_ispeed = cfg.baudRate;
+    tio.c_ospeed = cfg.baudRate;
+
+    // 数据位
+    switch (cfg.dataBits){
+    case 5: tio.c_cflag |= CS5; break;
+    case 6: tio.c_cflag |= CS6; break;
+    case 7: tio.c_cflag |= CS7; break;
+    case 8: tio.c_cflag |= CS8; break;
+    default:
+        fprintf(stderr, "The dataBits:%d is not support\n", cfg.dataBits);
+        return false;
+    }
+
+    // 校验位
+    if(cfg.parity == PARITY_ODD){
+        tio.c_cflag |= PARENB | PARODD;
+    }else if(cfg.parity == PARITY_EVEN){
+        tio.c_cflag |= PARENB;
+    }
+
+    // 停止位
+    if(cfg.stopBits == 2){
+        tio.c_cflag |= CSTOPB;
+    }
+
+    // 设置等待时间和最小接收字符
+    tio.c_cc[VTIME] = 0;
+    tio.c_cc[VMIN] = 1;
+
+    // 刷新串口:处理未接收字符
+    ioctl(fd, TCFLSH, TCIOFLUSH);
+
+    if(ioctl(fd, TCSETS2, &tio) < 0){
+        fprintf(stderr, "Fail to TCSETS2,err:%s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool uartApplyRs485(int fd, const UartConfig &cfg)
+{
+    struct serial_rs485 rs485;
+    memset(&rs485, 0, sizeof(rs485));
+
+    if(cfg.rs485){
+        rs485.flags = SER_RS485_ENABLED;
+        // 发送期间 RTS 的电平，取决于收发器 DE 引脚的接法
+        rs485.flags |= cfg.rtsOnSend ? SER_RS485_RTS_ON_SEND : SER_RS485_RTS_AFTER_SEND;
+        rs485.delay_rts_before_send = cfg.delayRtsBeforeSendMs;
+        rs485.delay_rts_after_send = cfg.delayRtsAfterSendMs;
+    }
+
+    if(ioctl(fd, TIOCSRS485, &rs485) < 0){
+        fprintf(stderr, "Fail to TIOCSRS485,err:%s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,16 @@
+#ifndef _UART_TERMIOS2_H
+#define _UART_TERMIOS2_H
+
+#include "linux_uart.h"
+
+/*
+ * termios2 与 glibc 的 <termios.h> 不能在同一个编译单元中使用，
+ * 因此单独放在 uart_termios2.cpp 中。
+ */
+
+// 用 termios2 + BOTHER 设置任意波特率、数据位、校验位、停止位
+bool uartApplyTermios2(int fd, const UartConfig &cfg);
+// 设置内核 RS-485 模式(RTS 方向控制及收发切换延时)
+bool uartApplyRs485(int fd, const UartConfig &cfg);
+
+#endif
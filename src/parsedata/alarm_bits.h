@@ -0,0 +1,35 @@
+#ifndef _ALARM_BITS_H
+#define _ALARM_BITS_H
+// alarm_bits.h
+
+#include <stdint.h>
+
+/*
+ * 报警位原样保存：报警字节区第 k 个字节的第 b 位对应编号 k*8+b，
+ * 与各解析器 alarmMap 的 Bit 编号一致。编号 0~63 在 lo，64~127 在 hi。
+ */
+struct AlarmBits
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    bool test(int bit) const {
+        return bit < 64 ? (lo >> bit) & 1 : (hi >> (bit - 64)) & 1;
+    }
+    bool any() const { return lo || hi; }
+};
+
+inline AlarmBits alarmBitsFromBytes(const uint8_t* bytes, int count)
+{
+    AlarmBits bits = {0, 0};
+    for (int k = 0; k < count && k < 16; ++k) {
+        if (k < 8) bits.lo |= uint64_t(bytes[k]) << (8 * k);
+        else       bits.hi |= uint64_t(bytes[k]) << (8 * (k - 8));
+    }
+    return bits;
+}
+
+inline AlarmBits operator^(const AlarmBits& a, const AlarmBits& b) { AlarmBits r = {a.lo ^ b.lo, a.hi ^ b.hi}; return r; }
+inline AlarmBits operator&(const AlarmBits& a, const AlarmBits& b) { AlarmBits r = {a.lo & b.lo, a.hi & b.hi}; return r; }
+
+#endif
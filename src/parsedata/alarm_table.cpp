@@ -0,0 +1,58 @@
+#include "alarm_table.h"
+#include <mutex>
+
+AlarmTable::AlarmTable(int bitCount, const std::unordered_map<int, std::string>& names)
+    : labels(bitCount), defined(bitCount, false)
+{
+    for (int bit = 0; bit < bitCount; ++bit) {
+        auto it = names.find(bit);
+        if (it != names.end()) {
+            labels[bit] = it->second;
+            defined[bit] = true;
+        } else {
+            labels[bit] = "未知报警 Bit" + std::to_string(bit);
+        }
+    }
+}
+
+const char* AlarmTable::name(int bit) const
+{
+    if (bit < 0 || bit >= bitCount() || !defined[bit]) return nullptr;
+    return labels[bit].c_str();
+}
+
+const char* AlarmTable::label(int bit) const
+{
+    if (bit < 0 || bit >= bitCount()) return nullptr;
+    return labels[bit].c_str();
+}
+
+int AlarmTable::collect(const AlarmBits& bits, const char** out) const
+{
+    int count = 0;
+    for (int bit = 0; bit < bitCount(); ++bit) {
+        if (bits.test(bit)) out[count++] = labels[bit].c_str();
+    }
+    return count;
+}
+
+static std::mutex registryMutex;
+
+static std::unordered_map<std::string, std::shared_ptr<const AlarmTable>>& registry()
+{
+    static std::unordered_map<std::string, std::shared_ptr<const AlarmTable>> tables;
+    return tables;
+}
+
+void registerAlarmTable(const std::string& source, std::shared_ptr<const AlarmTable> table)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry()[source] = table;
+}
+
+std::shared_ptr<const AlarmTable> findAlarmTable(const std::string& source)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = registry().find(source);
+    return it != registry().end() ? it->second : nullptr;
+}
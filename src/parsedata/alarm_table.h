@@ -0,0 +1,38 @@
+#ifndef _ALARM_TABLE_H
+#define _ALARM_TABLE_H
+// alarm_table.h
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "alarm_bits.h"
+
+/*
+ * 报警位文本表：由各帧的 Bit 编号 -> 文本映射构造，
+ * 未定义的位生成 "未知报警 BitN"。构造后只读，查询不分配内存。
+ */
+class AlarmTable
+{
+    public:
+        AlarmTable(int bitCount, const std::unordered_map<int, std::string>& names);
+
+        int bitCount() const { return int(labels.size()); }
+        // 已定义的报警文本，未定义返回 nullptr
+        const char* name(int bit) const;
+        // 报警文本，未定义时为 "未知报警 BitN"，超出范围返回 nullptr
+        const char* label(int bit) const;
+        // 按位号顺序取出所有置位报警的文本指针，返回个数
+        int collect(const AlarmBits& bits, const char** out) const;
+
+    private:
+        std::vector<std::string> labels;
+        std::vector<bool> defined;
+};
+
+// 按来源(数据表名)登记由描述文件生成的报警表，查询端据此解析报警文本
+void registerAlarmTable(const std::string& source, std::shared_ptr<const AlarmTable> table);
+// 未登记返回空指针
+std::shared_ptr<const AlarmTable> findAlarmTable(const std::string& source);
+
+#endif
@@ -0,0 +1,117 @@
+// decode_program.cpp
+#include "decode_program.h"
+#include <cstring>
+
+bool DecodeProgram::compile(int frame, const FrameSpec& spec, std::string& err)
+{
+    if (spec.length > DecodedFrame::MAX_FRAME) {
+        err = spec.table + ": frame longer than " + std::to_string(DecodedFrame::MAX_FRAME);
+        return false;
+    }
+    if (int(spec.fields.size()) > DecodedFrame::MAX_FIELDS) {
+        err = spec.table + ": more than " + std::to_string(DecodedFrame::MAX_FIELDS) + " fields";
+        return false;
+    }
+
+    frame_ = frame;
+    length_ = spec.length;
+    alarmOffset = spec.alarmOffset;
+    alarmBytes = spec.alarmBytes;
+    ops.clear();
+    divisors.clear();
+    for (size_t i = 0; i < spec.fields.size(); ++i) {
+        const FieldSpec& field = spec.fields[i];
+        uint8_t code = uint8_t(field.type * 2 + (field.real ? 1 : 0));
+        divisors.push_back(field.divisor);
+
+        // 与上一段同类且偏移等距时并入上一段
+        if (!ops.empty()) {
+            DecodeOp& last = ops.back();
+            int next = last.offset + last.count * last.stride;
+            int stride = field.offset - (last.offset + (last.count - 1) * last.stride);
+            if (last.code == code && last.count < 255
+                && ((last.count == 1 && stride > 0 && stride < 256) || (last.count > 1 && field.offset == next))) {
+                if (last.count == 1) last.stride = uint8_t(stride);
+                ++last.count;
+                continue;
+            }
+        }
+        DecodeOp op;
+        op.code = code;
+        op.count = 1;
+        op.stride = 0;
+        op.first = uint8_t(i);
+        op.offset = uint16_t(field.offset);
+        ops.push_back(op);
+    }
+    alarmTable = std::make_shared<AlarmTable>(alarmBytes * 8, spec.alarmNames);
+    return true;
+}
+
+static inline uint32_t be16(const uint8_t* p) { return uint32_t(p[0]) << 8 | p[1]; }
+static inline uint32_t le16(const uint8_t* p) { return uint32_t(p[1]) << 8 | p[0]; }
+static inline uint32_t be32(const uint8_t* p) { return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3]; }
+static inline uint32_t le32(const uint8_t* p) { return uint32_t(p[3]) << 24 | uint32_t(p[2]) << 16 | uint32_t(p[1]) << 8 | p[0]; }
+
+// 取数方式和是否缩放合成一个操作码，每段只分派一次；
+// 缩放在 float 中完成，与手写解析器 (float)原始值 / 除数 的结果逐位一致
+#define DECODE_CASE(type, load)                                                     \
+    case type * 2:                                                                  \
+        for (int k = 0; k < n; ++k, p += stride) v[k] = double(load);               \
+        break;                                                                      \
+    case type * 2 + 1:                                                              \
+        for (int k = 0; k < n; ++k, p += stride) v[k] = double(float(load) / d[k]); \
+        break;
+
+void DecodeProgram::decodeValues(const uint8_t* buf, double* values) const
+{
+    for (const DecodeOp& op : ops) {
+        const uint8_t* p = buf + op.offset;
+        double* v = values + op.first;
+        const float* d = divisors.data() + op.first;
+        const int n = op.count;
+        const int stride = op.stride;
+        switch (op.code) {
+        DECODE_CASE(FIELD_U8, uint32_t(p[0]))
+        DECODE_CASE(FIELD_U16BE, be16(p))
+        DECODE_CASE(FIELD_U16LE, le16(p))
+        DECODE_CASE(FIELD_S16BE, int32_t(int16_t(be16(p))))
+        DECODE_CASE(FIELD_S16LE, int32_t(int16_t(le16(p))))
+        DECODE_CASE(FIELD_U32BE, be32(p))
+        DECODE_CASE(FIELD_U32LE, le32(p))
+        DECODE_CASE(FIELD_S32BE, int32_t(be32(p)))
+        DECODE_CASE(FIELD_S32LE, int32_t(le32(p)))
+        }
+    }
+}
+
+#undef DECODE_CASE
+
+AlarmBits DecodeProgram::decodeAlarms(const uint8_t* buf) const
+{
+    return alarmBitsFromBytes(buf + alarmOffset, alarmBytes);
+}
+
+void DecodeProgram::decode(const uint8_t* buf, const RxTimestamp& rx, DecodedFrame& out) const
+{
+    out.frame = frame_;
+    out.len = length_;
+    std::memcpy(out.raw, buf, length_);
+    out.fieldCount = int(divisors.size());
+    decodeValues(buf, out.values);
+    out.alarmBits = decodeAlarms(buf);
+    out.rx = rx;
+}
+
+bool compileDeviceProfile(const DeviceProfile& profile, std::vector<DecodeProgram>& programs, std::string& err)
+{
+    programs.clear();
+    programs.resize(profile.frames.size());
+    for (size_t i = 0; i < profile.frames.size(); ++i) {
+        if (!programs[i].compile(int(i), profile.frames[i], err)) return false;
+    }
+    for (const DecodeProgram& program : programs) {
+        registerAlarmTable(profile.frames[program.frame()].table, program.alarmTablePtr());
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef _DECODE_PROGRAM_H
+#define _DECODE_PROGRAM_H
+// decode_program.h
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "rx_timestamp.h"
+#include "alarm_bits.h"
+#include "alarm_table.h"
+#include "device_profile.h"
+
+/*
+ * 描述文件中的一种帧编译成的解码程序：取数方式相同、偏移等距的相邻字段合成一条指令，
+ * 每条指令分派一次后在紧凑循环里解码整段字段(常见的连续 16 位寄存器区只需一两条指令)。
+ * 指令和除数连续存放，解码时顺序执行一遍，不再查 JSON、不分配内存。
+ */
+
+// 按描述文件解码的一帧，定长、可按值拷贝入队
+struct DecodedFrame
+{
+    static const int MAX_FRAME = 256;
+    static const int MAX_FIELDS = 64;
+
+    int frame;                  // DeviceProfile::frames 下标
+    int len;
+    uint8_t raw[MAX_FRAME];
+    int fieldCount;
+    double values[MAX_FIELDS];  // 与 FrameSpec::fields 一一对应；整数字段为原始整数值
+    AlarmBits alarmBits;
+    RxTimestamp rx;
+};
+static_assert(std::is_trivially_copyable<DecodedFrame>::value, "DecodedFrame must stay trivially copyable");
+
+struct DecodeOp
+{
+    uint8_t code;               // FieldType * 2 + (按除数缩放 ? 1 : 0)
+    uint8_t count;              // 本段字段个数
+    uint8_t stride;             // 相邻字段的偏移差
+    uint8_t first;              // 第一个字段在 values/divisors 中的下标
+    uint16_t offset;            // 第一个字段的帧内偏移
+};
+
+class DecodeProgram
+{
+    public:
+        // 编译失败(字段过多等)时返回 false 并给出原因
+        bool compile(int frame, const FrameSpec& spec, std::string& err);
+
+        int frame() const { return frame_; }
+        int length() const { return length_; }
+        int fieldCount() const { return int(divisors.size()); }
+        int opCount() const { return int(ops.size()); }
+        const AlarmTable& alarms() const { return *alarmTable; }
+        std::shared_ptr<const AlarmTable> alarmTablePtr() const { return alarmTable; }
+
+        // buf 至少 length() 字节
+        void decodeValues(const uint8_t* buf, double* values) const;
+        AlarmBits decodeAlarms(const uint8_t* buf) const;
+        // 拷贝原始帧并解码全部字段和报警位
+        void decode(const uint8_t* buf, const RxTimestamp& rx, DecodedFrame& out) const;
+
+    private:
+        int frame_ = -1;
+        int length_ = 0;
+        int alarmOffset = 0;
+        int alarmBytes = 0;
+        std::vector<DecodeOp> ops;
+        std::vector<float> divisors;    // 每个字段一个，与 values 下标一致
+        std::shared_ptr<const AlarmTable> alarmTable;
+};
+
+// 编译描述文件中的全部帧，programs 与 profile.frames 下标一致；
+// 各帧报警表同时按表名登记(registerAlarmTable)，查询端可解析报警文本
+bool compileDeviceProfile(const DeviceProfile& profile, std::vector<DecodeProgram>& programs, std::string& err);
+
+#endif
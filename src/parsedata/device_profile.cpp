@@ -0,0 +1,291 @@
+// device_profile.cpp
+#include "device_profile.h"
+#include <fstream>
+#include <cstdlib>
+#include "faf5_parser.h"
+
+int fieldTypeWidth(FieldType type)
+{
+    switch (type) {
+    case FIELD_U8:
+        return 1;
+    case FIELD_U16BE: case FIELD_U16LE: case FIELD_S16BE: case FIELD_S16LE:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+int DeviceProfile::findFrame(const std::string& table) const
+{
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i].table == table) return int(i);
+    }
+    return -1;
+}
+
+static bool parseFieldType(const std::string& name, FieldType& type)
+{
+    static const struct { const char* name; FieldType type; } types[] = {
+        {"u8", FIELD_U8},
+        {"u16be", FIELD_U16BE}, {"u16le", FIELD_U16LE}, {"s16be", FIELD_S16BE}, {"s16le", FIELD_S16LE},
+        {"u32be", FIELD_U32BE}, {"u32le", FIELD_U32LE}, {"s32be", FIELD_S32BE}, {"s32le", FIELD_S32LE},
+    };
+    for (const auto& t : types) {
+        if (name == t.name) {
+            type = t.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 列名直接拼进建表/插入语句，只允许字母、数字、下划线和非 ASCII 字符(中文列名)
+static bool validIdentifier(const std::string& name)
+{
+    if (name.empty()) return false;
+    for (unsigned char c : name) {
+        if (c >= 0x80 || c == '_' || (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) continue;
+        return false;
+    }
+    return !(name[0] >= '0' && name[0] <= '9');
+}
+
+// 帧表的固定列，字段不能重名
+static bool reservedColumn(const std::string& name)
+{
+    static const char* fixed[] = {"id", "device_id", "frame", "active_alarms", "alarm_bits", "alarm_bits_hi",
+                                  "received_time", "rx_time_ns", "rx_mono_ns"};
+    for (const char* f : fixed) {
+        if (name == f) return true;
+    }
+    return false;
+}
+
+static bool parseFrame(const std::string& table, const Json::Value& node, FrameSpec& frame, std::string& err)
+{
+    if (!validIdentifier(table)) {
+        err = "invalid frame name: " + table;
+        return false;
+    }
+    frame.table = table;
+    frame.deviceId = node.get("device_id", table).asString();
+    frame.length = node.get("length", 0).asInt();
+    if (frame.length <= 0 || frame.length > 256) {
+        err = table + ": length must be 1~256";
+        return false;
+    }
+
+    const Json::Value& fields = node["fields"];
+    for (Json::ArrayIndex i = 0; i < fields.size(); ++i) {
+        const Json::Value& f = fields[i];
+        FieldSpec field;
+        field.column = f.get("column", "").asString();
+        field.label = f.get("label", field.column).asString();
+        field.unit = f.get("unit", "").asString();
+        field.offset = f.get("offset", -1).asInt();
+        if (!validIdentifier(field.column) || reservedColumn(field.column)) {
+            err = table + ": invalid column name '" + field.column + "'";
+            return false;
+        }
+        for (const FieldSpec& other : frame.fields) {
+            if (other.column == field.column) {
+                err = table + ": duplicate column " + field.column;
+                return false;
+            }
+        }
+        if (!parseFieldType(f.get("type", "u16be").asString(), field.type)) {
+            err = table + "." + field.column + ": unknown type " + f["type"].asString();
+            return false;
+        }
+        if (field.offset < 0 || field.offset + fieldTypeWidth(field.type) > frame.length) {
+            err = table + "." + field.column + ": offset out of frame";
+            return false;
+        }
+        field.real = f.isMember("divisor");
+        field.divisor = f.get("divisor", 1.0).asFloat();
+        if (field.divisor == 0.0f) {
+            err = table + "." + field.column + ": divisor is 0";
+            return false;
+        }
+        frame.fields.push_back(field);
+    }
+
+    const Json::Value& alarms = node["alarms"];
+    frame.alarmOffset = alarms.get("offset", 0).asInt();
+    frame.alarmBytes = alarms.get("bytes", 0).asInt();
+    if (frame.alarmBytes < 0 || frame.alarmBytes > 16
+        || (frame.alarmBytes > 0 && (frame.alarmOffset < 0 || frame.alarmOffset + frame.alarmBytes > frame.length))) {
+        err = table + ": alarm bytes out of frame (at most 16 bytes)";
+        return false;
+    }
+    const Json::Value& bits = alarms["bits"];
+    for (const std::string& key : bits.getMemberNames()) {
+        // 键必须是十进制位号，atoi 会把 "abc" 当成 0
+        if (key.empty() || key.size() > 3 || key.find_first_not_of("0123456789") != std::string::npos) {
+            err = table + ": alarm bit '" + key + "' is not a number";
+            return false;
+        }
+        int bit = std::atoi(key.c_str());
+        if (bit >= frame.alarmBytes * 8) {
+            err = table + ": alarm bit " + key + " out of range";
+            return false;
+        }
+        frame.alarmNames[bit] = bits[key].asString();
+    }
+    return true;
+}
+
+static bool parseParity(const std::string& name, UartParity& parity)
+{
+    if (name == "none") parity = PARITY_NONE;
+    else if (name == "odd") parity = PARITY_ODD;
+    else if (name == "even") parity = PARITY_EVEN;
+    else return false;
+    return true;
+}
+
+static bool parsePort(const Json::Value& node, const DeviceProfile& profile, PortSpec& port, std::string& err)
+{
+    port.device = node.get("device", "").asString();
+    if (port.device.empty()) {
+        err = "port without device";
+        return false;
+    }
+    port.uart = UartConfig(node.get("baud", 9600).asInt());
+    port.uart.dataBits = node.get("data_bits", 8).asInt();
+    port.uart.stopBits = node.get("stop_bits", 1).asInt();
+    port.uart.rs485 = node.get("rs485", false).asBool();
+    if (!parseParity(node.get("parity", "odd").asString(), port.uart.parity)) {
+        err = port.device + ": parity must be none/odd/even";
+        return false;
+    }
+    port.timeoutMs = node.get("timeout_ms", 500).asInt();
+    if (port.timeoutMs <= 0) {
+        err = port.device + ": timeout_ms must be positive";
+        return false;
+    }
+
+    std::string protocol = node.get("protocol", "").asString();
+    if (protocol == "faf5") {
+        port.protocol = PROTOCOL_FAF5;
+        const Json::Value& frames = node["frames"];
+        for (Json::ArrayIndex i = 0; i < frames.size(); ++i) {
+            int frame = profile.findFrame(frames[i].asString());
+            if (frame < 0) {
+                err = port.device + ": unknown frame " + frames[i].asString();
+                return false;
+            }
+            int length = profile.frames[frame].length;
+            if (length < FaF5Parser::MIN_FRAME || length > FaF5Parser::MAX_FRAME) {
+                err = port.device + ": faf5 frame " + frames[i].asString() + " length out of range";
+                return false;
+            }
+            if (port.frames.size() >= size_t(FaF5Parser::MAX_LENGTHS)) {
+                err = port.device + ": at most " + std::to_string(FaF5Parser::MAX_LENGTHS) + " faf5 frames per port";
+                return false;
+            }
+            // 同一端口上的帧按长度区分
+            for (int other : port.frames) {
+                if (profile.frames[other].length == length) {
+                    err = port.device + ": frames " + profile.frames[other].table + " and "
+                        + profile.frames[frame].table + " have the same length";
+                    return false;
+                }
+            }
+            port.frames.push_back(frame);
+        }
+        if (port.frames.empty()) {
+            err = port.device + ": faf5 port without frames";
+            return false;
+        }
+    } else if (protocol == "modbus_rtu") {
+        port.protocol = PROTOCOL_MODBUS_RTU;
+        const Json::Value& polls = node["polls"];
+        for (Json::ArrayIndex i = 0; i < polls.size(); ++i) {
+            const Json::Value& p = polls[i];
+            PollSpec poll;
+            poll.slave = uint8_t(p.get("slave", 1).asUInt());
+            poll.function = uint8_t(p.get("function", 3).asUInt());
+            poll.address = uint16_t(p.get("address", 0).asUInt());
+            poll.count = uint16_t(p.get("count", 0).asUInt());
+            poll.periodMs = p.get("period_ms", 1000).asInt();
+            poll.frame = profile.findFrame(p.get("frame", "").asString());
+            if (poll.frame < 0) {
+                err = port.device + ": unknown frame " + p["frame"].asString();
+                return false;
+            }
+            if (poll.periodMs <= 0) {
+                err = port.device + ": period_ms must be positive";
+                return false;
+            }
+            if (poll.function != 3 && poll.function != 4) {
+                err = port.device + ": only function 3/4 can be polled";
+                return false;
+            }
+            // 应答帧：地址 + 功能码 + 字节数 + 数据 + CRC
+            if (poll.count == 0 || poll.count > 125 || profile.frames[poll.frame].length != 5 + 2 * poll.count) {
+                err = port.device + ": frame " + p["frame"].asString() + " length does not match register count";
+                return false;
+            }
+            port.polls.push_back(poll);
+        }
+    } else {
+        err = port.device + ": protocol must be faf5 or modbus_rtu";
+        return false;
+    }
+    return true;
+}
+
+bool parseDeviceProfile(const Json::Value& root, DeviceProfile& profile, std::string& err)
+{
+    profile = DeviceProfile();
+    if (!root.isObject()) {
+        err = "profile root is not an object";
+        return false;
+    }
+    // jsoncpp 的 asInt()/asString() 等遇到类型不符(如 "offset": "5")时抛出 Json::LogicError，
+    // 在这里转成错误信息，指明出错的帧或端口
+    std::string where = "profile";
+    try {
+        profile.name = root.get("name", "").asString();
+        profile.database = root.get("database", "/userdata/sqlite/lop1.db").asString();
+
+        const Json::Value& frames = root["frames"];
+        for (const std::string& table : frames.getMemberNames()) {
+            where = "frame " + table;
+            FrameSpec frame;
+            if (!parseFrame(table, frames[table], frame, err)) return false;
+            profile.frames.push_back(frame);
+        }
+
+        const Json::Value& ports = root["ports"];
+        for (Json::ArrayIndex i = 0; i < ports.size(); ++i) {
+            where = "ports[" + std::to_string(i) + "]";
+            PortSpec port;
+            if (!parsePort(ports[i], profile, port, err)) return false;
+            profile.ports.push_back(port);
+        }
+    } catch (const Json::Exception& e) {
+        err = where + ": wrong value type (" + e.what() + ")";
+        return false;
+    }
+    return true;
+}
+
+bool loadDeviceProfile(const std::string& path, DeviceProfile& profile, std::string& err)
+{
+    std::ifstream in(path.c_str());
+    if (!in) {
+        err = "cannot open " + path;
+        return false;
+    }
+    Json::CharReaderBuilder builder;
+    Json::Value root;
+    std::string parseErr;
+    if (!Json::parseFromStream(builder, in, &root, &parseErr)) {
+        err = path + ": " + parseErr;
+        return false;
+    }
+    return parseDeviceProfile(root, profile, err);
+}
@@ -0,0 +1,107 @@
+#ifndef _DEVICE_PROFILE_H
+#define _DEVICE_PROFILE_H
+// device_profile.h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <json/json.h>
+#include "linux_uart.h"
+
+/*
+ * 设备描述文件(JSON)：串口、协议、帧字段布局、缩放和报警位表，
+ * 启动时读入并编译成 DecodeProgram，换机型只需换描述文件，不用重新编译。
+ *
+ * {
+ *   "name": "...", "database": "/userdata/sqlite/lop1.db",
+ *   "frames": {
+ *     "lop1_frame1": {
+ *       "device_id": "LOP1_frame1", "length": 35,
+ *       "fields": [ {"column": "rpm1", "label": "转速", "unit": "rpm", "offset": 5, "type": "u16be"},
+ *                   {"column": "oil_pressure", ..., "offset": 7, "type": "u16be", "divisor": 100} ],
+ *       "alarms": {"offset": 21, "bytes": 9, "bits": {"1": "滑油压力低", ...}}
+ *     }
+ *   },
+ *   "ports": [
+ *     {"device": "/dev/ttyS7", "baud": 9600, "parity": "odd", "protocol": "faf5",
+ *      "frames": ["lop1_frame1", "lop1_frame2"]},
+ *     {"device": "/dev/ttyS3", "baud": 9600, "protocol": "modbus_rtu", "timeout_ms": 500,
+ *      "polls": [{"slave": 1, "function": 3, "address": 0, "count": 30, "period_ms": 500, "frame": "lop2_frame"}]}
+ *   ]
+ * }
+ *
+ * 字段偏移按整帧计(FA F5 帧从帧头算起，Modbus 从应答帧地址字节算起)。
+ * 给出 divisor 的字段按 原始值/divisor 存为 REAL，否则存为 INTEGER。
+ */
+
+// 字段原始值的宽度、符号和字节序
+enum FieldType {
+    FIELD_U8,
+    FIELD_U16BE, FIELD_U16LE, FIELD_S16BE, FIELD_S16LE,
+    FIELD_U32BE, FIELD_U32LE, FIELD_S32BE, FIELD_S32LE
+};
+
+int fieldTypeWidth(FieldType type);
+
+struct FieldSpec
+{
+    std::string column;     // 数据库列名，同时作为 JSON 字段名
+    std::string label;
+    std::string unit;
+    int offset;
+    FieldType type;
+    float divisor;
+    bool real;              // true: 原始值/divisor 存 REAL；false: 原始值存 INTEGER
+};
+
+struct FrameSpec
+{
+    std::string table;      // 数据表名，同时作为报警来源名
+    std::string deviceId;   // 入库的 device_id，默认同表名
+    int length;             // 整帧字节数
+    std::vector<FieldSpec> fields;
+    int alarmOffset;        // 报警字节区起始偏移，没有报警区时 alarmBytes 为 0
+    int alarmBytes;
+    std::unordered_map<int, std::string> alarmNames;
+};
+
+enum PortProtocol { PROTOCOL_FAF5, PROTOCOL_MODBUS_RTU };
+
+// Modbus 轮询任务，应答帧按 frame 解码
+struct PollSpec
+{
+    uint8_t slave;
+    uint8_t function;       // 3 或 4
+    uint16_t address;
+    uint16_t count;
+    int periodMs;
+    int frame;              // DeviceProfile::frames 下标
+};
+
+struct PortSpec
+{
+    std::string device;
+    UartConfig uart;
+    PortProtocol protocol;
+    std::vector<int> frames;    // FA F5：本端口可能出现的帧(按帧长区分)
+    int timeoutMs;              // Modbus 应答超时
+    std::vector<PollSpec> polls;
+};
+
+struct DeviceProfile
+{
+    std::string name;
+    std::string database;
+    std::vector<FrameSpec> frames;
+    std::vector<PortSpec> ports;
+
+    // 按表名查帧，找不到返回 -1
+    int findFrame(const std::string& table) const;
+};
+
+// 读入并校验描述文件，失败时 err 给出原因
+bool loadDeviceProfile(const std::string& path, DeviceProfile& profile, std::string& err);
+bool parseDeviceProfile(const Json::Value& root, DeviceProfile& profile, std::string& err);
+
+#endif
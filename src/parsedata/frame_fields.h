@@ -0,0 +1,103 @@
+#ifndef _FRAME_FIELDS_H
+#define _FRAME_FIELDS_H
+// frame_fields.h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ctime>
+#include "rx_timestamp.h"
+
+/*
+ * 帧字段描述表：每个数值字段一行(文本、偏移、宽度、字节序、缩放、单位、数据库列)，
+ * 解码、建表、插入绑定和 JSON 输出都由同一张表生成。
+ * 新增一种帧只需新增一张表，不再手写 parse()/建表/绑定。
+ *
+ * 物理值 = 原始值 / divisor；divisor 为 1 且 u16 非空时按整数保存。
+ */
+template <typename Data>
+struct FieldDesc
+{
+    const char* label;      // 中文名，用于建表注释
+    const char* column;     // 数据库列名，同时作为 JSON 字段名
+    const char* unit;
+    uint8_t offset;         // 在帧中的字节偏移
+    uint8_t width;          // 1、2、4 字节
+    bool bigEndian;
+    float divisor;
+    uint16_t Data::*u16;    // 整数字段(INTEGER 列)
+    float Data::*f32;       // 实数字段(REAL 列)
+
+    constexpr bool isInteger() const { return u16 != nullptr; }
+    constexpr const char* sqlType() const { return u16 != nullptr ? "INTEGER" : "REAL"; }
+};
+
+// 大端 16 位整数字段
+template <typename Data>
+constexpr FieldDesc<Data> intField(const char* label, const char* column, const char* unit,
+                                   uint8_t offset, uint16_t Data::*member)
+{
+    return FieldDesc<Data>{label, column, unit, offset, 2, true, 1.0f, member, nullptr};
+}
+
+// 大端 16 位整数按 divisor 缩放的实数字段
+template <typename Data>
+constexpr FieldDesc<Data> realField(const char* label, const char* column, const char* unit,
+                                    uint8_t offset, float divisor, float Data::*member)
+{
+    return FieldDesc<Data>{label, column, unit, offset, 2, true, divisor, nullptr, member};
+}
+
+inline uint32_t loadField(const uint8_t* p, uint8_t width, bool bigEndian)
+{
+    switch (width) {
+    case 1:
+        return p[0];
+    case 2:
+        return bigEndian ? (uint32_t(p[0]) << 8 | p[1]) : (uint32_t(p[1]) << 8 | p[0]);
+    default:
+        return bigEndian ? (uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3])
+                         : (uint32_t(p[3]) << 24 | uint32_t(p[2]) << 16 | uint32_t(p[1]) << 8 | p[0]);
+    }
+}
+
+template <typename Data>
+inline void decodeField(const FieldDesc<Data>& f, const uint8_t* buf, Data& out)
+{
+    uint32_t raw = loadField(buf + f.offset, f.width, f.bigEndian);
+    if (f.u16) out.*(f.u16) = uint16_t(raw);
+    else       out.*(f.f32) = raw / f.divisor;
+}
+
+// 按下标递归展开，表为常量时每个字段编译为一次定长读取和一次存储
+template <typename Data, size_t N, size_t I>
+struct FieldDecoder
+{
+    static inline void run(const FieldDesc<Data> (&fields)[N], const uint8_t* buf, Data& out)
+    {
+        decodeField(fields[I], buf, out);
+        FieldDecoder<Data, N, I + 1>::run(fields, buf, out);
+    }
+};
+
+template <typename Data, size_t N>
+struct FieldDecoder<Data, N, N>
+{
+    static inline void run(const FieldDesc<Data> (&)[N], const uint8_t*, Data&) {}
+};
+
+template <typename Data, size_t N>
+inline void decodeFields(const FieldDesc<Data> (&fields)[N], const uint8_t* buf, Data& out)
+{
+    FieldDecoder<Data, N, 0>::run(fields, buf, out);
+}
+
+// 解析结果的接收时间
+template <typename Data>
+inline void setFrameTime(Data& out, const RxTimestamp& rx)
+{
+    out.timestamp = std::time_t(rx.realNs / 1000000000LL);
+    out.rxMonoNs = rx.monoNs;
+    out.rxRealNs = rx.realNs;
+}
+
+#endif
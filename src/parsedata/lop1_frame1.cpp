@@ -2,8 +2,8 @@
 #include <cstring> 
 #include "lop1_frame1.h"
 
-// 静态报警映射表初始化
-const std::unordered_map<int, std::string> LOP1Frame1Parser::alarmMap = LOP1Frame1Parser::initAlarmBitMap();
+// 静态报警文本表初始化
+const AlarmTable LOP1Frame1Parser::alarms(ALARM_BITS, LOP1Frame1Parser::initAlarmBitMap());
 
 // 生成报警bit位到文本的映射：Bit编号 = (ByteIndex - 21) * 8 + BitIndex
 std::unordered_map <int, std::string> LOP1Frame1Parser::initAlarmBitMap() {
@@ -87,47 +87,18 @@ std::unordered_map <int, std::string> LOP1Frame1Parser::initAlarmBitMap() {
     return map;
 }
 
-// 大端字节序解析两个字节为 uint16_t
-uint16_t LOP1Frame1Parser::to_uint16(const uint8_t* ptr) {
-    //return ptr[0] | (ptr[1] << 8); 小端
-    return (ptr[0] << 8) | ptr[1];
-}
-
-
-std::vector<std::string> LOP1Frame1Parser::extractActiveAlarms(const uint8_t *buffer)
-{
-    std::vector<std::string> active;
-    for (int byteIdx = 21; byteIdx <= 29; ++byteIdx) {
-        uint8_t val = buffer[byteIdx];
-        for (int bit = 0; bit < 8; ++bit) {
-            if (val & (1 << bit)) {
-                int bitIndex = (byteIdx - 21) * 8 + bit;
-                auto it = alarmMap.find(bitIndex);
-                if (it != alarmMap.end()) {
-                    active.push_back(it->second);
-                } else {
-                    active.push_back("未知报警 Bit" + std::to_string(bitIndex));
-                }
-            }
-        }
-    }
-    return active;
+bool LOP1Frame1Parser::parse(const uint8_t buffer[35], LOP1Frame1Data& result) {
+    return parse(buffer, result, rxTimestampNow());
 }
 
-bool LOP1Frame1Parser::parse(const uint8_t buffer[35], LOP1Frame1Data& result) {
+bool LOP1Frame1Parser::parse(const uint8_t buffer[35], LOP1Frame1Data& result, const RxTimestamp& rx) {
 
-    std::memcpy(result.ram_frame, buffer, 35);
-    result.rpm = to_uint16(&buffer[5]);
-    result.oilPressure = to_uint16(&buffer[7]) / 100.0f;
-    result.freshwatertemp = to_uint16(&buffer[9]) / 10.0f;
-    result.Arowtemp = to_uint16(&buffer[11]);
-    result.Browtemp = to_uint16(&buffer[13]);
-    result.toothoiltemp = to_uint16(&buffer[15]) / 10.0f;
-    result.toothoilpressure = to_uint16(&buffer[17]) / 100.0f;
-    result.Seawaterpressure = to_uint16(&buffer[19]) / 100.0f;
+    std::memcpy(result.ram_frame, buffer, FRAME_LEN);
+    decodeFields(LOP1_FRAME1_FIELDS, buffer, result);
 
     //检测报警位
-    result.activeAlarms = extractActiveAlarms(buffer);
-    result.timestamp = std::time(nullptr);
+    result.alarmBits = alarmBitsFromBytes(buffer + ALARM_BYTE, ALARM_BYTES);
+    result.activeAlarmCount = alarms.collect(result.alarmBits, result.activeAlarms);
+    setFrameTime(result, rx);
     return true;
 }
\ No newline at end of file
@@ -2,8 +2,8 @@
 #include <cstring> 
 #include "lop1_frame2.h"
 
-// 静态报警映射表初始化
-const std::unordered_map<int, std::string> LOP1Frame2Parser::alarmMap = LOP1Frame2Parser::initAlarmBitMap();
+// 静态报警文本表初始化
+const AlarmTable LOP1Frame2Parser::alarms(ALARM_BITS, LOP1Frame2Parser::initAlarmBitMap());
 
 // 生成报警bit位到文本的映射：Bit编号 = (ByteIndex - 21) * 8 + BitIndex
 std::unordered_map <int, std::string> LOP1Frame2Parser::initAlarmBitMap() {
@@ -47,45 +47,18 @@ std::unordered_map <int, std::string> LOP1Frame2Parser::initAlarmBitMap() {
     return map;
 }
 
-// 大端字节序解析两个字节为 uint16_t
-uint16_t LOP1Frame2Parser::to_uint16(const uint8_t* ptr) {
-    //return ptr[0] | (ptr[1] << 8); 小端
-    return (ptr[0] << 8) | ptr[1];
-}
-
-
-std::vector<std::string> LOP1Frame2Parser::extractActiveAlarms(const uint8_t *buffer)
-{
-    std::vector<std::string> active;
-    for (int byteIdx = 21; byteIdx <= 25; ++byteIdx) {
-        uint8_t val = buffer[byteIdx];
-        for (int bit = 0; bit < 8; ++bit) {
-            if (val & (1 << bit)) {
-                int bitIndex = (byteIdx - 21) * 8 + bit;
-                auto it = alarmMap.find(bitIndex);
-                if (it != alarmMap.end()) {
-                    active.push_back(it->second);
-                } else {
-                    active.push_back("未知报警 Bit" + std::to_string(bitIndex));
-                }
-            }
-        }
-    }
-    return active;
+bool LOP1Frame2Parser::parse(const uint8_t buffer[32], LOP1Frame2Data& result) {
+    return parse(buffer, result, rxTimestampNow());
 }
 
-bool LOP1Frame2Parser::parse(const uint8_t buffer[32], LOP1Frame2Data& result) {
+bool LOP1Frame2Parser::parse(const uint8_t buffer[32], LOP1Frame2Data& result, const RxTimestamp& rx) {
 
-    std::memcpy(result.ram_frame, buffer, 32);
-    result.rpm = to_uint16(&buffer[5]);
-    result.oiltemp = to_uint16(&buffer[7]) / 10.0f;
-    result.inlettemp = to_uint16(&buffer[9]) / 10.0f;
-    result.inletpressure = to_uint16(&buffer[11]) / 100.0f;
-    result.oilpressure = to_uint16(&buffer[13]) / 100.0f;
-    result.freshwaterpressure = to_uint16(&buffer[15]) / 100.0f;
+    std::memcpy(result.ram_frame, buffer, FRAME_LEN);
+    decodeFields(LOP1_FRAME2_FIELDS, buffer, result);
 
     //检测报警位
-    result.activeAlarms = extractActiveAlarms(buffer);
-    result.timestamp = std::time(nullptr);
+    result.alarmBits = alarmBitsFromBytes(buffer + ALARM_BYTE, ALARM_BYTES);
+    result.activeAlarmCount = alarms.collect(result.alarmBits, result.activeAlarms);
+    setFrameTime(result, rx);
     return true;
 }
\ No newline at end of file
@@ -4,10 +4,14 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
-#include <string>
 #include <ctime>
+#include <string>
 #include <unordered_map>
+#include <type_traits>
+#include "rx_timestamp.h"
+#include "alarm_bits.h"
+#include "alarm_table.h"
+#include "frame_fields.h"
 
 struct LOP1Frame2Data {
     uint8_t ram_frame[32];
@@ -17,19 +21,47 @@ struct LOP1Frame2Data {
     float inletpressure;
     float oilpressure;
     float freshwaterpressure;
-    std::vector<std::string> activeAlarms;
+    AlarmBits alarmBits;   // 报警字节区原始位，入库和边沿检测用
+    const char* activeAlarms[5 * 8];   // 当前报警文本，指向解析器的静态报警表
+    int activeAlarmCount;
     std::time_t timestamp;
+    int64_t rxMonoNs;      // 串口读到帧的时间(CLOCK_MONOTONIC, ns)
+    int64_t rxRealNs;      // 同一时刻的墙上时间(CLOCK_REALTIME, ns)
+};
+
+// 解析结果不含堆内存，可按值放入队列
+static_assert(std::is_trivially_copyable<LOP1Frame2Data>::value, "LOP1Frame2Data must be trivially copyable");
+
+// 数值字段描述表：解码、建表、插入绑定、JSON 输出均由此生成
+constexpr FieldDesc<LOP1Frame2Data> LOP1_FRAME2_FIELDS[] = {
+    intField ("转速", "rpm2", "rpm", 5, &LOP1Frame2Data::rpm),
+    realField("滑油温度", "oil_temp", "℃", 7, 10.0f, &LOP1Frame2Data::oiltemp),
+    realField("进气温度", "inlet_temp", "℃", 9, 10.0f, &LOP1Frame2Data::inlettemp),
+    realField("进气压力", "inlet_pressure", "bar", 11, 100.0f, &LOP1Frame2Data::inletpressure),
+    realField("燃油压力", "燃油压", "bar", 13, 100.0f, &LOP1Frame2Data::oilpressure),
+    realField("淡水压力", "淡水压", "bar", 15, 100.0f, &LOP1Frame2Data::freshwaterpressure)
 };
 
 class LOP1Frame2Parser {
     public:
+        static const int FRAME_LEN = 32;
+        // 报警字节区: buffer[ALARM_BYTE] 起 ALARM_BYTES 个字节
+        static const int ALARM_BYTE = 21;
+        static const int ALARM_BYTES = 5;
+        static const int ALARM_BITS = ALARM_BYTES * 8;
+
+        // 报警位编号对应的文本，未定义的位返回 nullptr
+        static const char* alarmName(int bit) { return alarms.name(bit); }
+        // 同上，未定义的位返回 "未知报警 BitN"(启动时生成，不分配内存)
+        static const char* alarmLabel(int bit) { return alarms.label(bit); }
+
         bool parse(const uint8_t buffer[32], LOP1Frame2Data& result);
+        // rx 为帧到达时间，不带 rx 的版本以解析时刻代替
+        bool parse(const uint8_t buffer[32], LOP1Frame2Data& result, const RxTimestamp& rx);
 
     private:
-        uint16_t to_uint16(const uint8_t* ptr);
-        std::vector<std::string> extractActiveAlarms(const uint8_t* buffer);
         static std::unordered_map<int, std::string> initAlarmBitMap();
-        static const std::unordered_map<int, std::string> alarmMap;
+        static const AlarmTable alarms;
 };
 
 
@@ -2,8 +2,8 @@
 #include <cstring> 
 #include "lop2_frame.h"
 
-// 静态报警映射表初始化
-const std::unordered_map<int, std::string> LOP2FrameParser::alarmMap = LOP2FrameParser::initAlarmBitMap();
+// 静态报警文本表初始化
+const AlarmTable LOP2FrameParser::alarms(ALARM_BITS, LOP2FrameParser::initAlarmBitMap());
 
 // 生成报警bit位到文本的映射：Bit编号 = (ByteIndex - 55) * 8 + BitIndex
 std::unordered_map <int, std::string> LOP2FrameParser::initAlarmBitMap() {
@@ -66,56 +66,18 @@ std::unordered_map <int, std::string> LOP2FrameParser::initAlarmBitMap() {
     return map;
 }
 
-// 大端字节序解析两个字节为 uint16_t
-uint16_t LOP2FrameParser::to_uint16(const uint8_t* ptr) {
-    //return ptr[0] | (ptr[1] << 8); 小端
-    return (ptr[0] << 8) | ptr[1];
-}
-
-
-std::vector<std::string> LOP2FrameParser::extractActiveAlarms(const uint8_t *buffer)
-{
-    std::vector<std::string> active;
-    for (int byteIdx = 55; byteIdx <= 62; ++byteIdx) {
-        uint8_t val = buffer[byteIdx];
-        for (int bit = 0; bit < 8; ++bit) {
-            if (val & (1 << bit)) {
-                int bitIndex = (byteIdx - 55) * 8 + bit;
-                auto it = alarmMap.find(bitIndex);
-                if (it != alarmMap.end()) {
-                    active.push_back(it->second);
-                } else {
-                    active.push_back("未知报警 Bit" + std::to_string(bitIndex));
-                }
-            }
-        }
-    }
-    return active;
+bool LOP2FrameParser::parse(const uint8_t buffer[65], LOP2FrameData& result) {
+    return parse(buffer, result, rxTimestampNow());
 }
 
-bool LOP2FrameParser::parse(const uint8_t buffer[65], LOP2FrameData& result) {
+bool LOP2FrameParser::parse(const uint8_t buffer[65], LOP2FrameData& result, const RxTimestamp& rx) {
 
-    std::memcpy(result.ram_frame, buffer, 65);
-    result.rpm = to_uint16(&buffer[3]);
-    result.runtime = to_uint16(&buffer[5]);
-    result.insideairtemp = to_uint16(&buffer[7]) / 10.0f;
-    result.oiltemp = to_uint16(&buffer[9]) / 10.0f;
-    result.freashwatertemp = to_uint16(&buffer[11]) / 10.0f;
-    result.Arowtemp = to_uint16(&buffer[13]) / 10.0f;
-    result.Browtemp = to_uint16(&buffer[15]) / 10.0f;
-    result.Uphasetemp = to_uint16(&buffer[17]) / 10.0f;
-    result.Vphasetemp = to_uint16(&buffer[19]) / 10.0f;
-    result.Wphasetemp = to_uint16(&buffer[21]) / 10.0f;
-    result.frontbearingtemp = to_uint16(&buffer[23]) / 10.0f;
-    result.rearbearingtemp = to_uint16(&buffer[25]) / 10.0f;
-    result.inletairtemp = to_uint16(&buffer[27]) / 10.0f;
-    result.outletairtemp = to_uint16(&buffer[29]) / 10.0f;
-    result.oilpressure = to_uint16(&buffer[31]) / 1000.0f;
-    result.airpressure = to_uint16(&buffer[33]) / 1000.0f;
-    result.fuelpressure = to_uint16(&buffer[35]) / 1000.0f;
+    std::memcpy(result.ram_frame, buffer, FRAME_LEN);
+    decodeFields(LOP2_FRAME_FIELDS, buffer, result);
 
     //检测报警位
-    result.activeAlarms = extractActiveAlarms(buffer);
-    result.timestamp = std::time(nullptr);
+    result.alarmBits = alarmBitsFromBytes(buffer + ALARM_BYTE, ALARM_BYTES);
+    result.activeAlarmCount = alarms.collect(result.alarmBits, result.activeAlarms);
+    setFrameTime(result, rx);
     return true;
 }
\ No newline at end of file
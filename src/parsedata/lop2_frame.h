@@ -4,10 +4,14 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
-#include <string>
 #include <ctime>
+#include <string>
 #include <unordered_map>
+#include <type_traits>
+#include "rx_timestamp.h"
+#include "alarm_bits.h"
+#include "alarm_table.h"
+#include "frame_fields.h"
 
 struct LOP2FrameData {
     uint8_t ram_frame[65];
@@ -28,19 +32,58 @@ struct LOP2FrameData {
     float oilpressure;
     float airpressure;
     float fuelpressure;
-    std::vector<std::string> activeAlarms;
+    AlarmBits alarmBits;   // 报警字节区原始位，入库和边沿检测用
+    const char* activeAlarms[8 * 8];   // 当前报警文本，指向解析器的静态报警表
+    int activeAlarmCount;
     std::time_t timestamp;
+    int64_t rxMonoNs;      // 串口读到帧的时间(CLOCK_MONOTONIC, ns)
+    int64_t rxRealNs;      // 同一时刻的墙上时间(CLOCK_REALTIME, ns)
+};
+
+// 解析结果不含堆内存，可按值放入队列
+static_assert(std::is_trivially_copyable<LOP2FrameData>::value, "LOP2FrameData must be trivially copyable");
+
+// 数值字段描述表：解码、建表、插入绑定、JSON 输出均由此生成
+constexpr FieldDesc<LOP2FrameData> LOP2_FRAME_FIELDS[] = {
+    intField ("转速", "rpm", "rpm", 3, &LOP2FrameData::rpm),
+    intField ("运行时间", "runtime", "", 5, &LOP2FrameData::runtime),
+    realField("内部空气温度", "insideairtemp", "℃", 7, 10.0f, &LOP2FrameData::insideairtemp),
+    realField("机油温度", "oiltemp", "℃", 9, 10.0f, &LOP2FrameData::oiltemp),
+    realField("淡水温度", "freashwatertemp", "℃", 11, 10.0f, &LOP2FrameData::freashwatertemp),
+    realField("A 排排温", "Arowtemp", "℃", 13, 10.0f, &LOP2FrameData::Arowtemp),
+    realField("B 排排温", "Browtemp", "℃", 15, 10.0f, &LOP2FrameData::Browtemp),
+    realField("U 相温度", "Uphasetemp", "℃", 17, 10.0f, &LOP2FrameData::Uphasetemp),
+    realField("V 相温度", "Vphasetemp", "℃", 19, 10.0f, &LOP2FrameData::Vphasetemp),
+    realField("W 相温度", "Wphasetemp", "℃", 21, 10.0f, &LOP2FrameData::Wphasetemp),
+    realField("前轴承温度", "frontbearingtemp", "℃", 23, 10.0f, &LOP2FrameData::frontbearingtemp),
+    realField("后轴承温度", "rearbearingtemp", "℃", 25, 10.0f, &LOP2FrameData::rearbearingtemp),
+    realField("进气温度", "inletairtemp", "℃", 27, 10.0f, &LOP2FrameData::inletairtemp),
+    realField("排气温度", "outletairtemp", "℃", 29, 10.0f, &LOP2FrameData::outletairtemp),
+    realField("机油压力", "oilpressure", "MPa", 31, 1000.0f, &LOP2FrameData::oilpressure),
+    realField("空气压力", "airpressure", "MPa", 33, 1000.0f, &LOP2FrameData::airpressure),
+    realField("燃油压力", "fuelpressure", "MPa", 35, 1000.0f, &LOP2FrameData::fuelpressure)
 };
 
 class LOP2FrameParser {
     public:
+        static const int FRAME_LEN = 65;
+        // 报警字节区: buffer[ALARM_BYTE] 起 ALARM_BYTES 个字节
+        static const int ALARM_BYTE = 55;
+        static const int ALARM_BYTES = 8;
+        static const int ALARM_BITS = ALARM_BYTES * 8;
+
+        // 报警位编号对应的文本，未定义的位返回 nullptr
+        static const char* alarmName(int bit) { return alarms.name(bit); }
+        // 同上，未定义的位返回 "未知报警 BitN"(启动时生成，不分配内存)
+        static const char* alarmLabel(int bit) { return alarms.label(bit); }
+
         bool parse(const uint8_t buffer[65], LOP2FrameData& result);
+        // rx 为帧到达时间，不带 rx 的版本以解析时刻代替
+        bool parse(const uint8_t buffer[65], LOP2FrameData& result, const RxTimestamp& rx);
 
     private:
-        uint16_t to_uint16(const uint8_t* ptr);
-        std::vector<std::string> extractActiveAlarms(const uint8_t* buffer);
         static std::unordered_map<int, std::string> initAlarmBitMap();
-        static const std::unordered_map<int, std::string> alarmMap;
+        static const AlarmTable alarms;
 };
 
 